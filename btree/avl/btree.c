@@ -0,0 +1,261 @@
+/*
+ * Binární vyhledávací strom — vyvažovaná varianta (AVL strom)
+ *
+ * Stejné rozhraní jako rekurzivní varianta, ale po každém vložení a
+ * odstranění se výšky podstromů libovolného uzlu liší nejvýše o jedna, takže
+ * hloubka stromu je O(log n) i při vkládání seřazených klíčů.
+ */
+
+#include "../btree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Gets height of the subtree, 0 for empty subtree
+static int bst_height(bst_node_t *tree) {
+  return tree ? tree->height : 0;
+}
+
+// Recomputes the height of the node from the heights of its children
+static void bst_update_height(bst_node_t *tree) {
+  int left = bst_height(tree->left);
+  int right = bst_height(tree->right);
+  tree->height = (left > right ? left : right) + 1;
+}
+
+// Moves the left child of the node to its place
+static void bst_rotate_right(bst_node_t **tree) {
+  bst_node_t *t = *tree;
+  bst_node_t *l = t->left;
+  t->left = l->right;
+  l->right = t;
+  bst_update_height(t);
+  bst_update_height(l);
+  *tree = l;
+}
+
+// Moves the right child of the node to its place
+static void bst_rotate_left(bst_node_t **tree) {
+  bst_node_t *t = *tree;
+  bst_node_t *r = t->right;
+  t->right = r->left;
+  r->left = t;
+  bst_update_height(t);
+  bst_update_height(r);
+  *tree = r;
+}
+
+// Restores the balance of the node after one of its subtrees changed height
+// by one
+static void bst_rebalance(bst_node_t **tree) {
+  bst_node_t *t = *tree;
+  int balance = bst_height(t->left) - bst_height(t->right);
+
+  if (balance > 1) {
+    // left-right case is first turned to left-left
+    if (bst_height(t->left->left) < bst_height(t->left->right)) {
+      bst_rotate_left(&t->left);
+    }
+    bst_rotate_right(tree);
+  } else if (balance < -1) {
+    if (bst_height(t->right->right) < bst_height(t->right->left)) {
+      bst_rotate_right(&t->right);
+    }
+    bst_rotate_left(tree);
+  } else {
+    bst_update_height(t);
+  }
+}
+
+/*
+ * Inicializace stromu.
+ *
+ * Uživatel musí zajistit, že inicializace se nebude opakovaně volat nad
+ * inicializovaným stromem. V opačném případě může dojít k úniku paměti (memory
+ * leak). Protože neinicializovaný ukazatel má nedefinovanou hodnotu, není
+ * možné toto detekovat ve funkci.
+ */
+void bst_init(bst_node_t **tree) {
+  *tree = NULL;
+}
+
+/*
+ * Vyhledání uzlu v stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * hodnotu daného uzlu. V opačném případě funkce vrátí hodnotu false a proměnná
+ * value zůstává nezměněná.
+ */
+bool bst_search(bst_node_t *tree, char key, int *value) {
+  // the tree is balanced, so there is no reason to recurse
+  while (tree && tree->key != key) {
+    tree = tree->key > key ? tree->left : tree->right;
+  }
+  return tree && (*value = tree->value, true);
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Pokud uzel se zadaným klíče už ve stromu existuje, nahraďte jeho hodnotu.
+ * Jinak vložte nový listový uzel a vyvažte uzly na cestě ke kořeni.
+ */
+void bst_insert(bst_node_t **tree, char key, int value) {
+  bst_node_t *t = *tree;
+
+  // create new
+  if (!t) {
+    bst_node_t *n = malloc(sizeof(*n));
+    if (!n) {
+      return;
+    }
+    n->left = NULL;
+    n->right = NULL;
+    n->value = value;
+    n->key = key;
+    n->height = 1;
+    *tree = n;
+    return;
+  }
+
+  // edit, the shape doesn't change
+  if (t->key == key) {
+    t->value = value;
+    return;
+  }
+
+  // go left/right and fix the balance on the way back
+  t->key > key ? bst_insert(&t->left, key, value)
+               : bst_insert(&t->right, key, value);
+  bst_rebalance(tree);
+}
+
+/*
+ * Pomocná funkce která nahradí uzel nejpravějším potomkem.
+ *
+ * Klíč a hodnota uzlu target budou nahrazeny klíčem a hodnotou nejpravějšího
+ * uzlu podstromu tree. Nejpravější potomek bude odstraněný a uzly na cestě k
+ * němu vyvážené.
+ *
+ * Funkce předpokládá, že hodnota tree není NULL.
+ */
+void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree) {
+  bst_node_t *t = *tree;
+  // continue to right
+  if (t->right) {
+    bst_replace_by_rightmost(target, &t->right);
+    bst_rebalance(tree);
+    return;
+  }
+
+  // edit target and remove the rightmost node, it has no right child
+  target->key = t->key;
+  target->value = t->value;
+  *tree = t->left;
+  free(t);
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Pokud uzel se zadaným klíčem neexistuje, funkce nic nedělá.
+ * Pokud má odstraněný uzel jeden podstrom, zdědí ho rodič odstraněného uzlu.
+ * Pokud má odstraněný uzel oba podstromy, je nahrazený nejpravějším uzlem
+ * levého podstromu. Uzly na cestě k odstraněnému uzlu jsou vyvážené.
+ */
+void bst_delete(bst_node_t **tree, char key) {
+  bst_node_t *t = *tree;
+
+  // key is not in the tree
+  if (!t) {
+    return;
+  }
+
+  if (t->key != key) {
+    t->key > key ? bst_delete(&t->left, key) : bst_delete(&t->right, key);
+    bst_rebalance(tree);
+    return;
+  }
+
+  // node found, the child of node with one child is a balanced leaf
+  if (!t->left || !t->right) {
+    *tree = t->left ? t->left : t->right;
+    free(t);
+    return;
+  }
+
+  bst_replace_by_rightmost(t, &t->left);
+  bst_rebalance(tree);
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Po zrušení se celý strom bude nacházet ve stejném stavu jako po
+ * inicializaci. Funkce korektně uvolní všechny alokované zdroje rušených
+ * uzlů.
+ */
+void bst_dispose(bst_node_t **tree) {
+  bst_node_t *t = *tree;
+
+  // tree is empty
+  if (!t) {
+    return;
+  }
+
+  // remove the childern and free self
+  bst_dispose(&t->left);
+  bst_dispose(&t->right);
+  free(t);
+  *tree = NULL;
+}
+
+/*
+ * Preorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
+ */
+void bst_preorder(bst_node_t *tree, bst_items_t *items) {
+  // nothing to add
+  if (!tree) {
+    return;
+  }
+
+  // add the nodes to the list in the correct order
+  bst_add_node_to_items(tree, items);
+  bst_preorder(tree->left, items);
+  bst_preorder(tree->right, items);
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
+ */
+void bst_inorder(bst_node_t *tree, bst_items_t *items) {
+  // nothing to add
+  if (!tree) {
+    return;
+  }
+
+  // add the nodes to the list in the correct order
+  bst_inorder(tree->left, items);
+  bst_add_node_to_items(tree, items);
+  bst_inorder(tree->right, items);
+}
+
+/*
+ * Postorder průchod stromem.
+ *
+ * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
+ */
+void bst_postorder(bst_node_t *tree, bst_items_t *items) {
+  // nothing to add
+  if (!tree) {
+    return;
+  }
+
+  // add the nodes to the list in the correct order
+  bst_postorder(tree->left, items);
+  bst_postorder(tree->right, items);
+  bst_add_node_to_items(tree, items);
+}
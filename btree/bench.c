@@ -0,0 +1,124 @@
+/*
+ * Měření výkonu binárního vyhledávacího stromu při různém pořadí vkládaných
+ * klíčů. Překládá se s každou variantou stromu (make bench).
+ *
+ * Použití: ./bench [počet opakování]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "btree.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef BST_VARIANT
+#define BST_VARIANT "?"
+#endif
+
+// Number of distinct char keys
+#define KEY_COUNT (CHAR_MAX - CHAR_MIN + 1)
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+// Gets the number of nodes visited by search of the key
+static int search_depth(bst_node_t *tree, char key) {
+  int depth = 1;
+  while (tree->key != key) {
+    tree = tree->key > key ? tree->left : tree->right;
+    ++depth;
+  }
+  return depth;
+}
+
+// Measures the depth of the tree and the time of inserting and searching
+// all the keys in the given order
+static void bench_order(const char *name, const char *keys, int rounds) {
+  long long insert = 0;
+  long long search = 0;
+  long long scan = 0;
+  long sum = 0;
+  bst_node_t *tree;
+  bst_items_t items = {NULL, 0, 0};
+
+  for (int r = 0; r < rounds; ++r) {
+    bst_init(&tree);
+    long long start = now_ns();
+    for (int i = 0; i < KEY_COUNT; ++i) {
+      bst_insert(&tree, keys[i], i);
+    }
+    insert += now_ns() - start;
+
+    start = now_ns();
+    for (int i = 0; i < KEY_COUNT; ++i) {
+      int value = 0;
+      bst_search(tree, keys[i], &value);
+      sum += value;
+    }
+    search += now_ns() - start;
+
+    // the items keep their capacity, so only the first round reallocates
+    items.size = 0;
+    start = now_ns();
+    bst_inorder(tree, &items);
+    scan += now_ns() - start;
+    sum += items.nodes[items.size - 1]->value;
+
+    if (r + 1 < rounds) {
+      bst_dispose(&tree);
+    }
+  }
+
+  int total = 0;
+  int max = 0;
+  for (int i = 0; i < KEY_COUNT; ++i) {
+    int depth = search_depth(tree, keys[i]);
+    total += depth;
+    max = depth > max ? depth : max;
+  }
+  bst_dispose(&tree);
+  free(items.nodes);
+
+  double ops = (double)rounds * KEY_COUNT;
+  printf("%-8s %8s %10.2f %10d %10.2f %10.2f %10.2f (%ld)\n", BST_VARIANT,
+         name, (double)total / KEY_COUNT, max, ops / (insert / 1e3),
+         ops / (search / 1e3), ops / (scan / 1e3), sum);
+}
+
+int main(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+  if (rounds <= 0) {
+    fprintf(stderr, "Invalid number of rounds\n");
+    return 1;
+  }
+
+  char sorted[KEY_COUNT];
+  char reverse[KEY_COUNT];
+  char random[KEY_COUNT];
+  for (int i = 0; i < KEY_COUNT; ++i) {
+    sorted[i] = CHAR_MIN + i;
+    reverse[i] = CHAR_MAX - i;
+    random[i] = CHAR_MIN + i;
+  }
+  unsigned rnd = 12345;
+  for (int i = KEY_COUNT - 1; i > 0; --i) {
+    rnd = rnd * 1103515245 + 12345;
+    int j = (rnd >> 8) % (i + 1);
+    char tmp = random[i];
+    random[i] = random[j];
+    random[j] = tmp;
+  }
+
+  printf("%d keys, %d rounds\n", KEY_COUNT, rounds);
+  printf("%-8s %8s %10s %10s %10s %10s %10s\n", "variant", "order",
+         "avg depth", "max depth", "insert M/s", "search M/s", "scan M/s");
+  bench_order("sorted", sorted, rounds);
+  bench_order("reverse", reverse, rounds);
+  bench_order("random", random, rounds);
+}
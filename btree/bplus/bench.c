@@ -0,0 +1,181 @@
+/*
+ * Měření výkonu B+ stromu. První tabulka má stejné klíče a sloupce jako
+ * ../bench.c, takže se dá porovnat s variantami rec a iter (make compare).
+ * Druhá porovnává B+ strom s generickým AVL stromem (../generic) na velkém
+ * počtu 64-bitových klíčů, který stromy s klíči typu char neudrží.
+ *
+ * Použití: ./bench [počet opakování] [počet klíčů]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../generic/gbst.h"
+#include "bplus.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+BSTDEC(int64_t, int, i64)
+BSTDEF(int64_t, int, i64, BST_CMP_NUM)
+
+// Number of distinct char keys
+#define KEY_COUNT (CHAR_MAX - CHAR_MIN + 1)
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+// Sums the values, so that the scan can't be optimized out
+static void visit_sum(int64_t key, int value, void *ctx) {
+  *(long *)ctx += value;
+}
+
+// Measures inserting, searching and scanning the char keys in the given
+// order, the same as ../bench.c. All the leaves have the same depth, it is
+// the number of nodes on the path from the root.
+static void bench_order(const char *name, const int64_t *keys, int rounds) {
+  long long insert = 0;
+  long long search = 0;
+  long long scan = 0;
+  long sum = 0;
+  bpt_tree_t tree;
+
+  for (int r = 0; r < rounds; ++r) {
+    bpt_init(&tree);
+    long long start = now_ns();
+    for (int i = 0; i < KEY_COUNT; ++i) {
+      bpt_insert(&tree, keys[i], i);
+    }
+    insert += now_ns() - start;
+
+    start = now_ns();
+    for (int i = 0; i < KEY_COUNT; ++i) {
+      int value = 0;
+      bpt_search(&tree, keys[i], &value);
+      sum += value;
+    }
+    search += now_ns() - start;
+
+    start = now_ns();
+    bpt_inorder(&tree, visit_sum, &sum);
+    scan += now_ns() - start;
+
+    if (r + 1 < rounds) {
+      bpt_dispose(&tree);
+    }
+  }
+
+  int depth = tree.height + 1;
+  bpt_dispose(&tree);
+
+  double ops = (double)rounds * KEY_COUNT;
+  printf("%-8s %8s %10.2f %10d %10.2f %10.2f %10.2f (%ld)\n", "bplus", name,
+         (double)depth, depth, ops / (insert / 1e3), ops / (search / 1e3),
+         ops / (scan / 1e3), sum);
+}
+
+// Measures the trees with `n` 64-bit keys, in nanoseconds per key
+static void bench_large(const char *name, const int64_t *keys, long n) {
+  long sum = 0;
+  bpt_tree_t bpt;
+  bpt_init(&bpt);
+  long long t0 = now_ns();
+  for (long i = 0; i < n; ++i) {
+    bpt_insert(&bpt, keys[i], i);
+  }
+  long long t1 = now_ns();
+  for (long i = 0; i < n; ++i) {
+    int value = 0;
+    bpt_search(&bpt, keys[i], &value);
+    sum += value;
+  }
+  long long t2 = now_ns();
+  bpt_inorder(&bpt, visit_sum, &sum);
+  long long t3 = now_ns();
+  printf("%-8s %8s %10.1f %10.1f %10.1f (%ld)\n", "bplus", name,
+         (t1 - t0) / (double)n, (t2 - t1) / (double)n, (t3 - t2) / (double)n,
+         sum);
+  bpt_dispose(&bpt);
+
+  sum = 0;
+  bst_i64_node_t *avl;
+  bst_i64_init(&avl);
+  t0 = now_ns();
+  for (long i = 0; i < n; ++i) {
+    bst_i64_insert(&avl, keys[i], i);
+  }
+  t1 = now_ns();
+  for (long i = 0; i < n; ++i) {
+    int value = 0;
+    bst_i64_search(avl, keys[i], &value);
+    sum += value;
+  }
+  t2 = now_ns();
+  bst_i64_inorder(avl, visit_sum, &sum);
+  t3 = now_ns();
+  printf("%-8s %8s %10.1f %10.1f %10.1f (%ld)\n", "avl", name,
+         (t1 - t0) / (double)n, (t2 - t1) / (double)n, (t3 - t2) / (double)n,
+         sum);
+  bst_i64_dispose(&avl);
+}
+
+int main(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+  long n = argc > 2 ? atol(argv[2]) : 1000000;
+  if (rounds <= 0 || n <= 0) {
+    fprintf(stderr, "Invalid number of rounds or keys\n");
+    return 1;
+  }
+
+  int64_t sorted[KEY_COUNT];
+  int64_t reverse[KEY_COUNT];
+  int64_t random[KEY_COUNT];
+  for (int i = 0; i < KEY_COUNT; ++i) {
+    sorted[i] = CHAR_MIN + i;
+    reverse[i] = CHAR_MAX - i;
+    random[i] = CHAR_MIN + i;
+  }
+  // the same shuffle as ../bench.c
+  unsigned rnd = 12345;
+  for (int i = KEY_COUNT - 1; i > 0; --i) {
+    rnd = rnd * 1103515245 + 12345;
+    int j = (rnd >> 8) % (i + 1);
+    int64_t tmp = random[i];
+    random[i] = random[j];
+    random[j] = tmp;
+  }
+
+  printf("%d keys, %d rounds\n", KEY_COUNT, rounds);
+  printf("%-8s %8s %10s %10s %10s %10s %10s\n", "variant", "order",
+         "avg depth", "max depth", "insert M/s", "search M/s", "scan M/s");
+  bench_order("sorted", sorted, rounds);
+  bench_order("reverse", reverse, rounds);
+  bench_order("random", random, rounds);
+
+  int64_t *keys = malloc(n * sizeof(*keys));
+  if (!keys) {
+    fprintf(stderr, "Failed to allocate the keys\n");
+    return 1;
+  }
+  for (long i = 0; i < n; ++i) {
+    keys[i] = i;
+  }
+  printf("\n%ld keys, ns per key\n", n);
+  printf("%-8s %8s %10s %10s %10s\n", "variant", "order", "insert",
+         "search", "scan");
+  bench_large("sorted", keys, n);
+  uint64_t state = 12345;
+  for (long i = n - 1; i > 0; --i) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    long j = (state >> 33) % (i + 1);
+    int64_t tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+  bench_large("random", keys, n);
+  free(keys);
+}
@@ -0,0 +1,469 @@
+/*
+ * B+ strom s širokými uzly
+ *
+ * Uzly mají BPT_NODE_SIZE bajtů a obsahují desítky klíčů uložených za sebou,
+ * takže vyhledání projde jen několik uzlů a v každém čte souvislou paměť.
+ * Hodnoty jsou jen v listech, které jsou propojené pro průchod podle klíčů.
+ */
+
+#include "bplus.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(bpt_leaf_t) <= BPT_NODE_SIZE, "leaf is too large");
+_Static_assert(sizeof(bpt_inner_t) <= BPT_NODE_SIZE, "inner is too large");
+
+// Minimal number of keys in a node other than the root
+#define LEAF_MIN (BPT_LEAF_KEYS / 2)
+#define INNER_MIN (BPT_INNER_KEYS / 2)
+
+// Result of insertion into a subtree
+typedef enum bpt_result {
+  BPT_FAIL,  // allocation failed, the subtree is unchanged
+  BPT_DONE,  // inserted or updated
+  BPT_SPLIT, // inserted and the node was split
+} bpt_result_t;
+
+// Allocates a node aligned to the cache line
+static void *bpt_alloc(void) {
+  return aligned_alloc(64, BPT_NODE_SIZE);
+}
+
+// Gets the index of the first key that is not less than `key`. The loop has
+// no data dependent branches (the condition compiles to a conditional move),
+// so it doesn't suffer from branch mispredictions.
+static int bpt_lower_bound(const int64_t *keys, int count, int64_t key) {
+  if (!count) {
+    return 0;
+  }
+  const int64_t *base = keys;
+  while (count > 1) {
+    int half = count / 2;
+    base = base[half] < key ? base + half : base;
+    count -= half;
+  }
+  return (base - keys) + (*base < key);
+}
+
+// Gets the index of the first key that is greater than `key`, this is the
+// index of the child of the inner node that may contain `key`
+static int bpt_upper_bound(const int64_t *keys, int count, int64_t key) {
+  if (!count) {
+    return 0;
+  }
+  const int64_t *base = keys;
+  while (count > 1) {
+    int half = count / 2;
+    base = base[half] <= key ? base + half : base;
+    count -= half;
+  }
+  return (base - keys) + (*base <= key);
+}
+
+// Finds the leaf that may contain the key, the tree must not be empty
+static bpt_leaf_t *bpt_find_leaf(const bpt_tree_t *tree, int64_t key) {
+  void *node = tree->root;
+  for (int h = tree->height; h > 0; --h) {
+    bpt_inner_t *inner = node;
+    node = inner->children[bpt_upper_bound(inner->keys, inner->count, key)];
+  }
+  return node;
+}
+
+// Inserts the key to the position i of the leaf that is not full
+static void bpt_leaf_put(bpt_leaf_t *leaf, int i, int64_t key, int value) {
+  int move = leaf->count - i;
+  memmove(leaf->keys + i + 1, leaf->keys + i, move * sizeof(*leaf->keys));
+  memmove(leaf->values + i + 1, leaf->values + i,
+          move * sizeof(*leaf->values));
+  leaf->keys[i] = key;
+  leaf->values[i] = value;
+  ++leaf->count;
+}
+
+// Removes the key at the position i of the leaf
+static void bpt_leaf_take(bpt_leaf_t *leaf, int i) {
+  int move = leaf->count - i - 1;
+  memmove(leaf->keys + i, leaf->keys + i + 1, move * sizeof(*leaf->keys));
+  memmove(leaf->values + i, leaf->values + i + 1,
+          move * sizeof(*leaf->values));
+  --leaf->count;
+}
+
+// Inserts the key to the position i and the child right of it to the inner
+// node that is not full
+static void bpt_inner_put(bpt_inner_t *inner, int i, int64_t key,
+                          void *child) {
+  int move = inner->count - i;
+  memmove(inner->keys + i + 1, inner->keys + i, move * sizeof(*inner->keys));
+  memmove(inner->children + i + 2, inner->children + i + 1,
+          move * sizeof(*inner->children));
+  inner->keys[i] = key;
+  inner->children[i + 1] = child;
+  ++inner->count;
+}
+
+// Removes the key at the position i and the child right of it
+static void bpt_inner_take(bpt_inner_t *inner, int i) {
+  int move = inner->count - i - 1;
+  memmove(inner->keys + i, inner->keys + i + 1, move * sizeof(*inner->keys));
+  memmove(inner->children + i + 1, inner->children + i + 2,
+          move * sizeof(*inner->children));
+  --inner->count;
+}
+
+// Inserts the key to the leaf, when the leaf is split the new right leaf
+// and its first key are returned in `split` and `split_key`
+static bpt_result_t bpt_insert_leaf(bpt_tree_t *tree, bpt_leaf_t *leaf,
+                                    int64_t key, int value,
+                                    int64_t *split_key, void **split) {
+  int i = bpt_lower_bound(leaf->keys, leaf->count, key);
+  if (i < leaf->count && leaf->keys[i] == key) {
+    leaf->values[i] = value;
+    return BPT_DONE;
+  }
+
+  ++tree->size;
+  if (leaf->count < BPT_LEAF_KEYS) {
+    bpt_leaf_put(leaf, i, key, value);
+    return BPT_DONE;
+  }
+
+  bpt_leaf_t *right = bpt_alloc();
+  if (!right) {
+    --tree->size;
+    return BPT_FAIL;
+  }
+  int half = (BPT_LEAF_KEYS + 1) / 2;
+  right->count = BPT_LEAF_KEYS - half;
+  memcpy(right->keys, leaf->keys + half, right->count * sizeof(*leaf->keys));
+  memcpy(right->values, leaf->values + half,
+         right->count * sizeof(*leaf->values));
+  right->next = leaf->next;
+  leaf->next = right;
+  leaf->count = half;
+
+  if (i <= half) {
+    bpt_leaf_put(leaf, i, key, value);
+  } else {
+    bpt_leaf_put(right, i - half, key, value);
+  }
+  *split_key = right->keys[0];
+  *split = right;
+  return BPT_SPLIT;
+}
+
+// Inserts the key to the subtree with `height` levels of inner nodes
+static bpt_result_t bpt_insert_node(bpt_tree_t *tree, void *node, int height,
+                                    int64_t key, int value,
+                                    int64_t *split_key, void **split) {
+  if (!height) {
+    return bpt_insert_leaf(tree, node, key, value, split_key, split);
+  }
+
+  bpt_inner_t *inner = node;
+  int i = bpt_upper_bound(inner->keys, inner->count, key);
+  // full node would have to split after the child split, the new node is
+  // allocated before, so that failure leaves the tree unchanged
+  bpt_inner_t *right = NULL;
+  if (inner->count == BPT_INNER_KEYS && !(right = bpt_alloc())) {
+    return BPT_FAIL;
+  }
+
+  int64_t child_key;
+  void *child;
+  bpt_result_t res = bpt_insert_node(tree, inner->children[i], height - 1,
+                                     key, value, &child_key, &child);
+  if (res != BPT_SPLIT) {
+    free(right);
+    return res;
+  }
+  if (!right) {
+    bpt_inner_put(inner, i, child_key, child);
+    return BPT_DONE;
+  }
+
+  // the middle key moves to the parent
+  int mid = BPT_INNER_KEYS / 2;
+  *split_key = inner->keys[mid];
+  right->count = BPT_INNER_KEYS - mid - 1;
+  memcpy(right->keys, inner->keys + mid + 1,
+         right->count * sizeof(*inner->keys));
+  memcpy(right->children, inner->children + mid + 1,
+         (right->count + 1) * sizeof(*inner->children));
+  inner->count = mid;
+
+  if (i <= mid) {
+    bpt_inner_put(inner, i, child_key, child);
+  } else {
+    bpt_inner_put(right, i - mid - 1, child_key, child);
+  }
+  *split = right;
+  return BPT_SPLIT;
+}
+
+// Fixes the leaf children[i] that has one key less than the minimum, by
+// moving a key from its neighbour or by merging with it
+static void bpt_fix_leaf(bpt_inner_t *parent, int i) {
+  int sep = i ? i - 1 : 0;
+  bpt_leaf_t *left = parent->children[sep];
+  bpt_leaf_t *right = parent->children[sep + 1];
+
+  if (left->count + right->count >= 2 * LEAF_MIN) {
+    if (left->count < right->count) {
+      bpt_leaf_put(left, left->count, right->keys[0], right->values[0]);
+      bpt_leaf_take(right, 0);
+    } else {
+      int last = left->count - 1;
+      bpt_leaf_put(right, 0, left->keys[last], left->values[last]);
+      bpt_leaf_take(left, last);
+    }
+    parent->keys[sep] = right->keys[0];
+    return;
+  }
+
+  memcpy(left->keys + left->count, right->keys,
+         right->count * sizeof(*right->keys));
+  memcpy(left->values + left->count, right->values,
+         right->count * sizeof(*right->values));
+  left->count += right->count;
+  left->next = right->next;
+  free(right);
+  bpt_inner_take(parent, sep);
+}
+
+// Fixes the inner node children[i] that has one key less than the minimum,
+// the keys rotate through the separator in the parent
+static void bpt_fix_inner(bpt_inner_t *parent, int i) {
+  int sep = i ? i - 1 : 0;
+  bpt_inner_t *left = parent->children[sep];
+  bpt_inner_t *right = parent->children[sep + 1];
+
+  if (left->count + right->count >= 2 * INNER_MIN) {
+    if (left->count < right->count) {
+      left->keys[left->count] = parent->keys[sep];
+      left->children[left->count + 1] = right->children[0];
+      ++left->count;
+      parent->keys[sep] = right->keys[0];
+      memmove(right->keys, right->keys + 1,
+              (right->count - 1) * sizeof(*right->keys));
+      memmove(right->children, right->children + 1,
+              right->count * sizeof(*right->children));
+      --right->count;
+    } else {
+      memmove(right->keys + 1, right->keys,
+              right->count * sizeof(*right->keys));
+      memmove(right->children + 1, right->children,
+              (right->count + 1) * sizeof(*right->children));
+      right->keys[0] = parent->keys[sep];
+      right->children[0] = left->children[left->count];
+      ++right->count;
+      parent->keys[sep] = left->keys[--left->count];
+    }
+    return;
+  }
+
+  left->keys[left->count] = parent->keys[sep];
+  memcpy(left->keys + left->count + 1, right->keys,
+         right->count * sizeof(*right->keys));
+  memcpy(left->children + left->count + 1, right->children,
+         (right->count + 1) * sizeof(*right->children));
+  left->count += right->count + 1;
+  free(right);
+  bpt_inner_take(parent, sep);
+}
+
+// Deletes the key from the subtree, returns true if the node has less keys
+// than the minimum after it
+static bool bpt_delete_node(bpt_tree_t *tree, void *node, int height,
+                            int64_t key) {
+  if (!height) {
+    bpt_leaf_t *leaf = node;
+    int i = bpt_lower_bound(leaf->keys, leaf->count, key);
+    if (i == leaf->count || leaf->keys[i] != key) {
+      return false;
+    }
+    bpt_leaf_take(leaf, i);
+    --tree->size;
+    return leaf->count < LEAF_MIN;
+  }
+
+  bpt_inner_t *inner = node;
+  int i = bpt_upper_bound(inner->keys, inner->count, key);
+  if (!bpt_delete_node(tree, inner->children[i], height - 1, key)) {
+    return false;
+  }
+  if (height == 1) {
+    bpt_fix_leaf(inner, i);
+  } else {
+    bpt_fix_inner(inner, i);
+  }
+  return inner->count < INNER_MIN;
+}
+
+// Frees the subtree with `height` levels of inner nodes
+static void bpt_dispose_node(void *node, int height) {
+  if (height) {
+    bpt_inner_t *inner = node;
+    for (int i = 0; i <= inner->count; ++i) {
+      bpt_dispose_node(inner->children[i], height - 1);
+    }
+  }
+  free(node);
+}
+
+/*
+ * Inicializace prázdného stromu.
+ */
+void bpt_init(bpt_tree_t *tree) {
+  tree->root = NULL;
+  tree->height = 0;
+  tree->size = 0;
+  tree->first = NULL;
+}
+
+/*
+ * Vyhledání klíče ve stromu.
+ *
+ * V případě úspěchu vrátí funkce true a do value zapíše hodnotu klíče, jinak
+ * vrátí false a value zůstává nezměněná.
+ */
+bool bpt_search(const bpt_tree_t *tree, int64_t key, int *value) {
+  if (!tree->root) {
+    return false;
+  }
+  bpt_leaf_t *leaf = bpt_find_leaf(tree, key);
+  int i = bpt_lower_bound(leaf->keys, leaf->count, key);
+  if (i < leaf->count && leaf->keys[i] == key) {
+    *value = leaf->values[i];
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Vložení klíče do stromu.
+ *
+ * Pokud klíč ve stromu už je, nahradí se jeho hodnota. Plné uzly se rozdělí
+ * na dva. Vrací false, pokud se nepodaří alokovat uzel, strom pak zůstává
+ * nezměněný.
+ */
+bool bpt_insert(bpt_tree_t *tree, int64_t key, int value) {
+  if (!tree->root) {
+    bpt_leaf_t *leaf = bpt_alloc();
+    if (!leaf) {
+      return false;
+    }
+    leaf->keys[0] = key;
+    leaf->values[0] = value;
+    leaf->count = 1;
+    leaf->next = NULL;
+    tree->root = leaf;
+    tree->first = leaf;
+    tree->size = 1;
+    return true;
+  }
+
+  // the new root must exist before the old one is split
+  bool full = tree->height
+                  ? ((bpt_inner_t *)tree->root)->count == BPT_INNER_KEYS
+                  : ((bpt_leaf_t *)tree->root)->count == BPT_LEAF_KEYS;
+  bpt_inner_t *root = NULL;
+  if (full && !(root = bpt_alloc())) {
+    return false;
+  }
+
+  int64_t split_key;
+  void *split;
+  bpt_result_t res = bpt_insert_node(tree, tree->root, tree->height, key,
+                                     value, &split_key, &split);
+  if (res != BPT_SPLIT) {
+    free(root);
+    return res == BPT_DONE;
+  }
+
+  root->keys[0] = split_key;
+  root->children[0] = tree->root;
+  root->children[1] = split;
+  root->count = 1;
+  tree->root = root;
+  ++tree->height;
+  return true;
+}
+
+/*
+ * Odstranění klíče ze stromu.
+ *
+ * Pokud klíč ve stromu není, funkce nic nedělá. Uzel, který má méně než
+ * polovinu klíčů, si vezme klíč od souseda, nebo se s ním spojí.
+ */
+void bpt_delete(bpt_tree_t *tree, int64_t key) {
+  if (!tree->root) {
+    return;
+  }
+  bpt_delete_node(tree, tree->root, tree->height, key);
+
+  // the root may have less keys, it is removed only when it is empty
+  if (tree->height) {
+    bpt_inner_t *root = tree->root;
+    if (!root->count) {
+      tree->root = root->children[0];
+      --tree->height;
+      free(root);
+    }
+  } else if (!((bpt_leaf_t *)tree->root)->count) {
+    free(tree->root);
+    bpt_init(tree);
+  }
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Po zrušení je strom ve stejném stavu jako po inicializaci.
+ */
+void bpt_dispose(bpt_tree_t *tree) {
+  if (tree->root) {
+    bpt_dispose_node(tree->root, tree->height);
+  }
+  bpt_init(tree);
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Zavolá visit pro všechny klíče od nejmenšího, prochází jen propojené
+ * listy.
+ */
+void bpt_inorder(const bpt_tree_t *tree, bpt_visit_t visit, void *ctx) {
+  for (bpt_leaf_t *leaf = tree->first; leaf; leaf = leaf->next) {
+    for (int i = 0; i < leaf->count; ++i) {
+      visit(leaf->keys[i], leaf->values[i], ctx);
+    }
+  }
+}
+
+/*
+ * Průchod klíči z intervalu <from, to>.
+ *
+ * Zavolá visit pro klíče z intervalu od nejmenšího a vrátí jejich počet.
+ */
+size_t bpt_range(const bpt_tree_t *tree, int64_t from, int64_t to,
+                 bpt_visit_t visit, void *ctx) {
+  if (!tree->root) {
+    return 0;
+  }
+  size_t count = 0;
+  bpt_leaf_t *leaf = bpt_find_leaf(tree, from);
+  int i = bpt_lower_bound(leaf->keys, leaf->count, from);
+  for (; leaf; leaf = leaf->next, i = 0) {
+    for (; i < leaf->count; ++i) {
+      if (leaf->keys[i] > to) {
+        return count;
+      }
+      visit(leaf->keys[i], leaf->values[i], ctx);
+      ++count;
+    }
+  }
+  return count;
+}
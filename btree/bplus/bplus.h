@@ -0,0 +1,53 @@
+/*
+ * Hlavičkový soubor pro B+ strom s širokými uzly.
+ */
+
+#ifndef IAL_BTREE_BPLUS_H
+#define IAL_BTREE_BPLUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Velikost uzlu v bajtech, násobek velikosti řádku cache (64 B)
+#define BPT_NODE_SIZE 512
+
+// Počet klíčů v listu a ve vnitřním uzlu, aby se uzel vešel do BPT_NODE_SIZE
+#define BPT_LEAF_KEYS 40
+#define BPT_INNER_KEYS 31
+
+// List, obsahuje klíče a hodnoty
+typedef struct bpt_leaf {
+  int64_t keys[BPT_LEAF_KEYS]; // seřazené klíče
+  int values[BPT_LEAF_KEYS];   // hodnoty klíčů
+  struct bpt_leaf *next;       // následující list, pro průchod
+  int count;                   // počet klíčů
+} bpt_leaf_t;
+
+// Vnitřní uzel, potomek i obsahuje klíče z intervalu <keys[i-1], keys[i])
+typedef struct bpt_inner {
+  int64_t keys[BPT_INNER_KEYS];          // seřazené oddělovací klíče
+  void *children[BPT_INNER_KEYS + 1];    // potomci (listy nebo vnitřní uzly)
+  int count;                             // počet klíčů
+} bpt_inner_t;
+
+// Strom
+typedef struct bpt_tree {
+  void *root;        // kořen, NULL pro prázdný strom
+  int height;        // počet úrovní vnitřních uzlů nad listy
+  size_t size;       // počet klíčů
+  bpt_leaf_t *first; // list s nejmenšími klíči
+} bpt_tree_t;
+
+typedef void (*bpt_visit_t)(int64_t key, int value, void *ctx);
+
+void bpt_init(bpt_tree_t *tree);
+bool bpt_insert(bpt_tree_t *tree, int64_t key, int value);
+bool bpt_search(const bpt_tree_t *tree, int64_t key, int *value);
+void bpt_delete(bpt_tree_t *tree, int64_t key);
+void bpt_dispose(bpt_tree_t *tree);
+void bpt_inorder(const bpt_tree_t *tree, bpt_visit_t visit, void *ctx);
+size_t bpt_range(const bpt_tree_t *tree, int64_t from, int64_t to,
+                 bpt_visit_t visit, void *ctx);
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Testy B+ stromu.
+ */
+
+#include "bplus.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  bool NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    bpt_tree_t tree;                                                           \
+    bpt_init(&tree);                                                           \
+    bool success = true;
+
+#define ENDTEST                                                                \
+  bpt_dispose(&tree);                                                          \
+  if (!success) printf("\x1b[91mFAILED\x1b[0m\n");                               \
+  return success;                                                              \
+  }
+
+// Checks the keys and sizes of the subtree with keys from <low, high),
+// returns the number of keys or -1 if the subtree is wrong
+static long check_node(void *node, int height, bool root, int64_t low,
+                       bool has_low, int64_t high, bool has_high) {
+  int64_t *keys;
+  int count;
+  if (height) {
+    bpt_inner_t *inner = node;
+    keys = inner->keys;
+    count = inner->count;
+    if ((!root && count < BPT_INNER_KEYS / 2) || count < 1) {
+      return -1;
+    }
+  } else {
+    bpt_leaf_t *leaf = node;
+    keys = leaf->keys;
+    count = leaf->count;
+    if ((!root && count < BPT_LEAF_KEYS / 2) || count < 1) {
+      return -1;
+    }
+  }
+  if (count > (height ? BPT_INNER_KEYS : BPT_LEAF_KEYS)) {
+    return -1;
+  }
+  for (int i = 0; i < count; ++i) {
+    if ((i && keys[i - 1] >= keys[i]) || (has_low && keys[i] < low) ||
+        (has_high && keys[i] >= high)) {
+      return -1;
+    }
+  }
+  if (!height) {
+    return count;
+  }
+
+  bpt_inner_t *inner = node;
+  long total = 0;
+  for (int i = 0; i <= count; ++i) {
+    long sub = check_node(inner->children[i], height - 1, false,
+                          i ? keys[i - 1] : low, i || has_low,
+                          i < count ? keys[i] : high, i < count || has_high);
+    if (sub < 0) {
+      return -1;
+    }
+    total += sub;
+  }
+  return total;
+}
+
+static bool check_tree(bpt_tree_t *tree) {
+  if (!tree->root) {
+    return tree->size == 0 && !tree->first;
+  }
+  long count =
+      check_node(tree->root, tree->height, true, 0, false, 0, false);
+  return count >= 0 && (size_t)count == tree->size;
+}
+
+// Visit function that checks the order and counts the keys
+static void visit_order(int64_t key, int value, void *ctx) {
+  int64_t *state = ctx; // {count, last key, ok}
+  if ((state[0] && key <= state[1]) || value != (int)(key * 7)) {
+    state[2] = 0;
+  }
+  ++state[0];
+  state[1] = key;
+}
+
+TEST(test_bpt_empty, "Search and delete in an empty tree")
+  int value = 5;
+  success &= !bpt_search(&tree, 1, &value) && value == 5;
+  bpt_delete(&tree, 1);
+  success &= check_tree(&tree);
+ENDTEST
+
+TEST(test_bpt_update, "Update the value of a key")
+  bpt_insert(&tree, 10, 1);
+  bpt_insert(&tree, 10, 8);
+  int value;
+  success &= bpt_search(&tree, 10, &value) && value == 8 && tree.size == 1;
+ENDTEST
+
+TEST(test_bpt_sorted, "Insert 100000 sorted keys")
+  for (int64_t i = 0; i < 100000; ++i) {
+    success &= bpt_insert(&tree, i * 3, (int)(i * 3 * 7));
+  }
+  printf("height %d\n", tree.height);
+  success &= check_tree(&tree) && tree.size == 100000;
+
+  int64_t state[3] = {0, 0, 1};
+  bpt_inorder(&tree, visit_order, state);
+  success &= state[0] == 100000 && state[2];
+
+  int value;
+  for (int64_t i = 0; i < 300000; ++i) {
+    bool found = bpt_search(&tree, i, &value);
+    success &= i % 3 ? !found : found && value == (int)(i * 7);
+  }
+ENDTEST
+
+TEST(test_bpt_random, "Random inserts and deletes against an array")
+  enum { RANGE = 20000 };
+  static int reference[RANGE]; // value + 1, 0 for missing key
+  unsigned rnd = 1;
+  for (int op = 0; op < 200000 && success; ++op) {
+    rnd = rnd * 1103515245 + 12345;
+    int64_t key = (rnd >> 8) % RANGE;
+    // more inserts first, then more deletes, so that the tree grows and
+    // shrinks back
+    bool insert = (rnd >> 4) % 8 < (op < 100000 ? 5 : 3);
+    if (insert) {
+      bpt_insert(&tree, key - RANGE / 2, (int)((key - RANGE / 2) * 7));
+      reference[key] = 1;
+    } else {
+      bpt_delete(&tree, key - RANGE / 2);
+      reference[key] = 0;
+    }
+    if (op % 10000 == 0) {
+      success &= check_tree(&tree);
+    }
+  }
+  success &= check_tree(&tree);
+
+  size_t count = 0;
+  for (int64_t key = 0; key < RANGE; ++key) {
+    int value;
+    bool found = bpt_search(&tree, key - RANGE / 2, &value);
+    success &= found == (bool)reference[key];
+    count += reference[key];
+  }
+  success &= tree.size == count;
+
+  int64_t state[3] = {0, 0, 1};
+  bpt_inorder(&tree, visit_order, state);
+  success &= (size_t)state[0] == count && state[2];
+
+  for (int64_t key = 0; key < RANGE; ++key) {
+    bpt_delete(&tree, key - RANGE / 2);
+  }
+  success &= check_tree(&tree) && !tree.root;
+ENDTEST
+
+TEST(test_bpt_range, "Visit the keys from an interval")
+  for (int64_t i = 0; i < 1000; ++i) {
+    bpt_insert(&tree, i * 2, (int)(i * 2 * 7));
+  }
+  int64_t state[3] = {0, 0, 1};
+  success &= bpt_range(&tree, 101, 500, visit_order, state) == 200;
+  success &= state[0] == 200 && state[1] == 500 && state[2];
+  success &= bpt_range(&tree, 2000, 3000, visit_order, state) == 0;
+  success &= bpt_range(&tree, -10, 0, visit_order, state) == 1;
+ENDTEST
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= test_bpt_empty();
+  success &= test_bpt_update();
+  success &= test_bpt_sorted();
+  success &= test_bpt_random();
+  success &= test_bpt_range();
+
+  if (success) {
+    printf("\x1b[92mALL PASS\x1b[0m\n");
+  } else {
+    printf("\x1b[91mSOME FAIL\x1b[0m\n");
+  }
+}
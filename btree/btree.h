@@ -11,6 +11,7 @@
 // Uzel stromu
 typedef struct bst_node {
   char key;               // klíč
+  signed char height;     // výška podstromu, používá jen varianta avl/
   int value;              // hodnota
   struct bst_node *left;  // levý potomek
   struct bst_node *right; // pravý potomek
@@ -0,0 +1,113 @@
+/*
+ * Měření výkonu generického stromu s 64-bitovými klíči. Porovnává
+ * porovnání vložené makrem BST_CMP_NUM s porovnáním voláním funkce přes
+ * ukazatel.
+ *
+ * Použití: ./bench [počet klíčů]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "gbst.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int u64_cmp(uint64_t a, uint64_t b) {
+  return (a > b) - (a < b);
+}
+
+// Volatile, so that the compiler can't see through the pointer and inline
+// the comparison, as with comparator chosen at runtime
+static int (*volatile u64_cmp_ptr)(uint64_t, uint64_t) = u64_cmp;
+#define CMP_PTR(A, B) u64_cmp_ptr(A, B)
+
+BSTDEC(uint64_t, uint64_t, inl)
+BSTDEF(uint64_t, uint64_t, inl, BST_CMP_NUM)
+
+BSTDEC(uint64_t, uint64_t, ptr)
+BSTDEF(uint64_t, uint64_t, ptr, CMP_PTR)
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static uint64_t splitmix(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// Measures inserting, finding, missing and deleting all the keys with the
+// tree of the given name
+#define BENCH(NAME, order, keys, misses, n)                                    \
+  do {                                                                         \
+    bst_##NAME##_node_t *tree;                                                 \
+    bst_##NAME##_init(&tree);                                                  \
+    uint64_t sum = 0;                                                          \
+    long long t0 = now_ns();                                                   \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      bst_##NAME##_insert(&tree, keys[i], i);                                  \
+    }                                                                          \
+    long long t1 = now_ns();                                                   \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      uint64_t value = 0;                                                      \
+      bst_##NAME##_search(tree, keys[i], &value);                              \
+      sum += value;                                                            \
+    }                                                                          \
+    long long t2 = now_ns();                                                   \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      uint64_t value = 0;                                                      \
+      sum += bst_##NAME##_search(tree, misses[i], &value);                     \
+    }                                                                          \
+    long long t3 = now_ns();                                                   \
+    for (size_t i = 0; i < n; ++i) {                                           \
+      bst_##NAME##_delete(&tree, keys[i]);                                     \
+    }                                                                          \
+    long long t4 = now_ns();                                                   \
+    printf("%-6s %8s %10.1f %10.1f %10.1f %10.1f (%llu)\n", #NAME, order,      \
+           (t1 - t0) / (double)n, (t2 - t1) / (double)n,                       \
+           (t3 - t2) / (double)n, (t4 - t3) / (double)n,                       \
+           (unsigned long long)sum);                                           \
+    bst_##NAME##_dispose(&tree);                                               \
+  } while (0)
+
+int main(int argc, char *argv[]) {
+  long n = argc > 1 ? atol(argv[1]) : 1000000;
+  if (n <= 0) {
+    fprintf(stderr, "Invalid number of keys\n");
+    return 1;
+  }
+
+  uint64_t *random = malloc(n * sizeof(*random));
+  uint64_t *sorted = malloc(n * sizeof(*sorted));
+  uint64_t *misses = malloc(n * sizeof(*misses));
+  if (!random || !sorted || !misses) {
+    fprintf(stderr, "Failed to allocate the keys\n");
+    return 1;
+  }
+  // keys are even and misses odd, so that no miss is in the tree
+  uint64_t rnd = 12345;
+  for (long i = 0; i < n; ++i) {
+    random[i] = splitmix(&rnd) & ~1ull;
+    sorted[i] = (uint64_t)i * 2;
+    misses[i] = splitmix(&rnd) | 1;
+  }
+
+  printf("%ld keys, ns per operation\n", n);
+  printf("%-6s %8s %10s %10s %10s %10s\n", "cmp", "order", "insert", "hit",
+         "miss", "delete");
+  BENCH(inl, "random", random, misses, n);
+  BENCH(ptr, "random", random, misses, n);
+  BENCH(inl, "sorted", sorted, misses, n);
+  BENCH(ptr, "sorted", sorted, misses, n);
+
+  free(random);
+  free(sorted);
+  free(misses);
+}
@@ -0,0 +1,209 @@
+/*
+ * Hlavičkový soubor pro generický vyvažovaný (AVL) binární vyhledávací
+ * strom s libovolným typem klíče a hodnoty.
+ */
+
+#ifndef IAL_BTREE_GENERIC_GBST_H
+#define IAL_BTREE_GENERIC_GBST_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/*
+ * Porovnání čísel pro BSTDEF, vrací zápornou hodnotu, 0 nebo kladnou
+ * hodnotu jako strcmp. Je to makro, takže se porovnání vloží přímo do
+ * funkcí stromu.
+ */
+#define BST_CMP_NUM(A, B) (((A) > (B)) - ((A) < (B)))
+
+/*
+ * Makro generující deklarace pro strom s klíči typu K a hodnotami typu V s
+ * názvovým infixem NAME. Pro NAME="u64", K="uint64_t", V="int":
+ *   Datové typy bst_u64_node_t, bst_u64_visit_t
+ *   Funkce void bst_u64_init(bst_u64_node_t **tree)
+ *           bool bst_u64_insert(bst_u64_node_t **tree, uint64_t key,
+ *                               int value)
+ *           bool bst_u64_search(bst_u64_node_t *tree, uint64_t key,
+ *                               int *value)
+ *           void bst_u64_delete(bst_u64_node_t **tree, uint64_t key)
+ *           void bst_u64_dispose(bst_u64_node_t **tree)
+ *           void bst_u64_inorder(bst_u64_node_t *tree, bst_u64_visit_t visit,
+ *                                void *ctx)
+ * Vkládání vrací false, pokud se nepodaří alokovat uzel. Průchod volá
+ * visit pro všechny uzly od nejmenšího klíče.
+ */
+#define BSTDEC(K, V, NAME)                                                     \
+  typedef struct bst_##NAME##_node {                                           \
+    K key;                                                                     \
+    V value;                                                                   \
+    signed char height;                                                        \
+    struct bst_##NAME##_node *left;                                            \
+    struct bst_##NAME##_node *right;                                           \
+  } bst_##NAME##_node_t;                                                       \
+                                                                               \
+  typedef void (*bst_##NAME##_visit_t)(K key, V value, void *ctx);             \
+                                                                               \
+  void bst_##NAME##_init(bst_##NAME##_node_t **tree);                          \
+  bool bst_##NAME##_insert(bst_##NAME##_node_t **tree, K key, V value);        \
+  bool bst_##NAME##_search(bst_##NAME##_node_t *tree, K key, V *value);        \
+  void bst_##NAME##_delete(bst_##NAME##_node_t **tree, K key);                 \
+  void bst_##NAME##_dispose(bst_##NAME##_node_t **tree);                       \
+  void bst_##NAME##_inorder(bst_##NAME##_node_t *tree,                         \
+                            bst_##NAME##_visit_t visit, void *ctx);
+
+/*
+ * Makro generující implementaci funkcí deklarovaných BSTDEC. CMP(a, b) je
+ * funkce nebo makro, které vrací zápornou hodnotu, 0 nebo kladnou hodnotu
+ * podle toho, jestli je klíč a menší, stejný nebo větší než b (např.
+ * BST_CMP_NUM pro čísla nebo strcmp pro řetězce). Uzly se po vložení a
+ * odstranění vyvažují jako AVL strom, takže hloubka je O(log n).
+ */
+#define BSTDEF(K, V, NAME, CMP)                                                \
+  static int bst_##NAME##_height(bst_##NAME##_node_t *tree) {                  \
+    return tree ? tree->height : 0;                                            \
+  }                                                                            \
+                                                                               \
+  static void bst_##NAME##_update(bst_##NAME##_node_t *tree) {                 \
+    int left = bst_##NAME##_height(tree->left);                                \
+    int right = bst_##NAME##_height(tree->right);                              \
+    tree->height = (left > right ? left : right) + 1;                          \
+  }                                                                            \
+                                                                               \
+  static void bst_##NAME##_rotate_right(bst_##NAME##_node_t **tree) {          \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    bst_##NAME##_node_t *l = t->left;                                          \
+    t->left = l->right;                                                        \
+    l->right = t;                                                              \
+    bst_##NAME##_update(t);                                                    \
+    bst_##NAME##_update(l);                                                    \
+    *tree = l;                                                                 \
+  }                                                                            \
+                                                                               \
+  static void bst_##NAME##_rotate_left(bst_##NAME##_node_t **tree) {           \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    bst_##NAME##_node_t *r = t->right;                                         \
+    t->right = r->left;                                                        \
+    r->left = t;                                                               \
+    bst_##NAME##_update(t);                                                    \
+    bst_##NAME##_update(r);                                                    \
+    *tree = r;                                                                 \
+  }                                                                            \
+                                                                               \
+  static void bst_##NAME##_rebalance(bst_##NAME##_node_t **tree) {             \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    int balance =                                                              \
+        bst_##NAME##_height(t->left) - bst_##NAME##_height(t->right);          \
+    if (balance > 1) {                                                         \
+      if (bst_##NAME##_height(t->left->left) <                                 \
+          bst_##NAME##_height(t->left->right)) {                               \
+        bst_##NAME##_rotate_left(&t->left);                                    \
+      }                                                                        \
+      bst_##NAME##_rotate_right(tree);                                         \
+    } else if (balance < -1) {                                                 \
+      if (bst_##NAME##_height(t->right->right) <                               \
+          bst_##NAME##_height(t->right->left)) {                               \
+        bst_##NAME##_rotate_right(&t->right);                                  \
+      }                                                                        \
+      bst_##NAME##_rotate_left(tree);                                          \
+    } else {                                                                   \
+      bst_##NAME##_update(t);                                                  \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void bst_##NAME##_init(bst_##NAME##_node_t **tree) { *tree = NULL; }         \
+                                                                               \
+  bool bst_##NAME##_insert(bst_##NAME##_node_t **tree, K key, V value) {       \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    if (!t) {                                                                  \
+      t = malloc(sizeof(*t));                                                  \
+      if (!t) {                                                                \
+        return false;                                                          \
+      }                                                                        \
+      t->key = key;                                                            \
+      t->value = value;                                                        \
+      t->left = NULL;                                                          \
+      t->right = NULL;                                                         \
+      t->height = 1;                                                           \
+      *tree = t;                                                               \
+      return true;                                                             \
+    }                                                                          \
+                                                                               \
+    int cmp = CMP(key, t->key);                                                \
+    if (!cmp) {                                                                \
+      t->value = value;                                                        \
+      return true;                                                             \
+    }                                                                          \
+    bool ok = bst_##NAME##_insert(cmp < 0 ? &t->left : &t->right, key,         \
+                                  value);                                      \
+    bst_##NAME##_rebalance(tree);                                              \
+    return ok;                                                                 \
+  }                                                                            \
+                                                                               \
+  bool bst_##NAME##_search(bst_##NAME##_node_t *tree, K key, V *value) {       \
+    while (tree) {                                                             \
+      int cmp = CMP(key, tree->key);                                           \
+      if (!cmp) {                                                              \
+        *value = tree->value;                                                  \
+        return true;                                                           \
+      }                                                                        \
+      tree = cmp < 0 ? tree->left : tree->right;                               \
+    }                                                                          \
+    return false;                                                              \
+  }                                                                            \
+                                                                               \
+  static void bst_##NAME##_replace_by_rightmost(bst_##NAME##_node_t *target,   \
+                                                bst_##NAME##_node_t **tree) {  \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    if (t->right) {                                                            \
+      bst_##NAME##_replace_by_rightmost(target, &t->right);                    \
+      bst_##NAME##_rebalance(tree);                                            \
+      return;                                                                  \
+    }                                                                          \
+    target->key = t->key;                                                      \
+    target->value = t->value;                                                  \
+    *tree = t->left;                                                           \
+    free(t);                                                                   \
+  }                                                                            \
+                                                                               \
+  void bst_##NAME##_delete(bst_##NAME##_node_t **tree, K key) {                \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    if (!t) {                                                                  \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    int cmp = CMP(key, t->key);                                                \
+    if (cmp) {                                                                 \
+      bst_##NAME##_delete(cmp < 0 ? &t->left : &t->right, key);                \
+      bst_##NAME##_rebalance(tree);                                            \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    if (!t->left || !t->right) {                                               \
+      *tree = t->left ? t->left : t->right;                                    \
+      free(t);                                                                 \
+      return;                                                                  \
+    }                                                                          \
+    bst_##NAME##_replace_by_rightmost(t, &t->left);                            \
+    bst_##NAME##_rebalance(tree);                                              \
+  }                                                                            \
+                                                                               \
+  void bst_##NAME##_dispose(bst_##NAME##_node_t **tree) {                      \
+    bst_##NAME##_node_t *t = *tree;                                            \
+    if (!t) {                                                                  \
+      return;                                                                  \
+    }                                                                          \
+    bst_##NAME##_dispose(&t->left);                                            \
+    bst_##NAME##_dispose(&t->right);                                           \
+    free(t);                                                                   \
+    *tree = NULL;                                                              \
+  }                                                                            \
+                                                                               \
+  void bst_##NAME##_inorder(bst_##NAME##_node_t *tree,                         \
+                            bst_##NAME##_visit_t visit, void *ctx) {           \
+    for (; tree; tree = tree->right) {                                         \
+      bst_##NAME##_inorder(tree->left, visit, ctx);                            \
+      visit(tree->key, tree->value, ctx);                                      \
+    }                                                                          \
+  }
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Testy generického binárního vyhledávacího stromu s číselnými a
+ * řetězcovými klíči.
+ */
+
+#include "gbst.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+BSTDEC(uint64_t, uint64_t, u64)
+BSTDEF(uint64_t, uint64_t, u64, BST_CMP_NUM)
+
+BSTDEC(const char *, int, str)
+BSTDEF(const char *, int, str, strcmp)
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  bool NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    bool success = true;
+
+#define ENDTEST                                                                \
+  if (!success) printf("\x1b[91mFAILED\x1b[0m\n");                               \
+  return success;                                                              \
+  }
+
+// Checks that the heights are correct and balanced, returns the height or
+// -1 if the subtree is wrong
+static int u64_check(bst_u64_node_t *tree) {
+  if (!tree) {
+    return 0;
+  }
+  int left = u64_check(tree->left);
+  int right = u64_check(tree->right);
+  if (left < 0 || right < 0 || left - right > 1 || right - left > 1 ||
+      (tree->left && tree->left->key >= tree->key) ||
+      (tree->right && tree->right->key <= tree->key)) {
+    return -1;
+  }
+  int height = (left > right ? left : right) + 1;
+  return tree->height == height ? height : -1;
+}
+
+// Visit function that checks the order and counts the nodes
+static void u64_visit(uint64_t key, uint64_t value, void *ctx) {
+  uint64_t *state = ctx; // {count, last key, ok}
+  if ((state[0] && key <= state[1]) || value != key * 3) {
+    state[2] = 0;
+  }
+  ++state[0];
+  state[1] = key;
+}
+
+static void str_visit(const char *key, int value, void *ctx) {
+  char *out = ctx;
+  strcat(out, key);
+  out[strlen(out)] = '0' + value;
+}
+
+TEST(test_u64_empty, "Search and delete in an empty tree")
+  bst_u64_node_t *tree;
+  bst_u64_init(&tree);
+  uint64_t value = 5;
+  success &= !bst_u64_search(tree, 1, &value) && value == 5;
+  bst_u64_delete(&tree, 1);
+  bst_u64_dispose(&tree);
+  success &= tree == NULL;
+ENDTEST
+
+TEST(test_u64_sorted, "Insert 100000 sorted 64-bit keys, check the balance")
+  bst_u64_node_t *tree;
+  bst_u64_init(&tree);
+  const uint64_t base = UINT64_C(1) << 40;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    success &= bst_u64_insert(&tree, base + i, (base + i) * 3);
+  }
+  int height = u64_check(tree);
+  printf("height %d\n", height);
+  success &= height > 0 && height <= 24;
+
+  uint64_t state[3] = {0, 0, 1};
+  bst_u64_inorder(tree, u64_visit, state);
+  success &= state[0] == 100000 && state[2];
+
+  uint64_t value;
+  success &= bst_u64_search(tree, base + 777, &value) &&
+             value == (base + 777) * 3;
+  success &= !bst_u64_search(tree, base - 1, &value);
+  bst_u64_dispose(&tree);
+  success &= tree == NULL;
+ENDTEST
+
+TEST(test_u64_delete, "Delete every other key of random 64-bit keys")
+  bst_u64_node_t *tree;
+  bst_u64_init(&tree);
+  uint64_t keys[5000];
+  uint64_t rnd = 42;
+  for (int i = 0; i < 5000; ++i) {
+    rnd = rnd * 6364136223846793005ull + 1442695040888963407ull;
+    keys[i] = rnd;
+    bst_u64_insert(&tree, keys[i], keys[i] * 3);
+  }
+  for (int i = 0; i < 5000; i += 2) {
+    bst_u64_delete(&tree, keys[i]);
+  }
+  success &= u64_check(tree) > 0;
+
+  for (int i = 0; i < 5000; ++i) {
+    uint64_t value;
+    bool found = bst_u64_search(tree, keys[i], &value);
+    success &= i % 2 ? found && value == keys[i] * 3 : !found;
+  }
+
+  uint64_t state[3] = {0, 0, 1};
+  bst_u64_inorder(tree, u64_visit, state);
+  success &= state[0] == 2500 && state[2];
+  bst_u64_dispose(&tree);
+ENDTEST
+
+TEST(test_str, "String keys with strcmp as the comparator")
+  bst_str_node_t *tree;
+  bst_str_init(&tree);
+  const char *keys[] = {"pear", "apple", "fig", "kiwi", "banana", "cherry"};
+  for (int i = 0; i < 6; ++i) {
+    bst_str_insert(&tree, keys[i], i);
+  }
+  bst_str_insert(&tree, "fig", 9);
+  bst_str_delete(&tree, "kiwi");
+  bst_str_delete(&tree, "plum");
+
+  // compare by content, not by the pointer
+  char key[] = "apple";
+  int value;
+  success &= bst_str_search(tree, key, &value) && value == 1;
+  success &= !bst_str_search(tree, "kiwi", &value);
+
+  char out[64] = "";
+  bst_str_inorder(tree, str_visit, out);
+  printf("%s\n", out);
+  success &= strcmp(out, "apple1banana4cherry5fig9pear0") == 0;
+  bst_str_dispose(&tree);
+ENDTEST
+
+int main(int argc, char *argv[]) {
+  bool success = true;
+  success &= test_u64_empty();
+  success &= test_u64_sorted();
+  success &= test_u64_delete();
+  success &= test_str();
+
+  if (success) {
+    printf("\x1b[92mALL PASS\x1b[0m\n");
+  } else {
+    printf("\x1b[91mSOME FAIL\x1b[0m\n");
+  }
+}
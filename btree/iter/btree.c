@@ -158,6 +158,9 @@ void bst_delete(bst_node_t **tree, char key) {
   bst_replace_by_rightmost(t, &t->left);
 }
 
+// with BST_MORRIS the traversals and dispose are in ../morris.c
+#ifndef BST_MORRIS
+
 /*
  * Zrušení celého stromu.
  *
@@ -183,6 +186,7 @@ void bst_dispose(bst_node_t **tree) {
     free(n);
   }
 
+  stack_bst_dispose(&stack);
   *tree = NULL;
 }
 
@@ -225,6 +229,7 @@ void bst_preorder(bst_node_t *tree, bst_items_t *items) {
 
     bst_add_node_to_items(n, items);
   }
+  stack_bst_dispose(&stack);
 }
 
 /*
@@ -263,6 +268,7 @@ void bst_inorder(bst_node_t *tree, bst_items_t *items) {
     bst_add_node_to_items(tree, items);
     bst_leftmost_inorder(tree->right, &nodes);
   }
+  stack_bst_dispose(&nodes);
 }
 
 /*
@@ -316,4 +322,8 @@ void bst_postorder(bst_node_t *tree, bst_items_t *items) {
     stack_bst_push(&nodes, tree);
     bst_leftmost_postorder(tree->right, &nodes, &first_visit);
   }
+  stack_bst_dispose(&nodes);
+  stack_bool_dispose(&first_visit);
 }
+
+#endif // BST_MORRIS
@@ -1,13 +1,13 @@
 /*
  * Hlavičkový soubor pro pomocné zásobníky.
- * Tento soubor neupravujte.
  */
 #ifndef IAL_BTREE_ITER_STACK_H
 #define IAL_BTREE_ITER_STACK_H
 
 #include "../btree.h"
 
-// Maximální velikost zásobníku
+// Počet položek uložených přímo ve struktuře zásobníku, větší zásobník
+// přesune položky na haldu
 #define MAXSTACK 30
 
 /*
@@ -19,19 +19,28 @@
  *           bst_node_t *stack_bst_pop(stack_bst_t *stack)
  *           bst_node_t *stack_bst_top(stack_bst_t *stack)
  *           bool stack_bst_empty(stack_bst_t *stack)
+ *           void stack_bst_dispose(stack_bst_t *stack)
  * A ekvivalent pro TNAME="bool", T="bool".
+ *
+ * Prvních MAXSTACK položek je v poli inline_items, potom se zásobník
+ * přesune do pole na haldě, které se při zaplnění zdvojnásobí. Zásobník je
+ * nutné po použití uvolnit funkcí dispose a nesmí se kopírovat, items může
+ * ukazovat do jeho vlastní struktury.
  */
 #define STACKDEC(T, TNAME)                                                     \
   typedef struct {                                                             \
-    T items[MAXSTACK];                                                         \
+    T *items;                                                                  \
     int top;                                                                   \
+    int capacity;                                                              \
+    T inline_items[MAXSTACK];                                                  \
   } stack_##TNAME##_t;                                                         \
                                                                                \
   void stack_##TNAME##_init(stack_##TNAME##_t *stack);                         \
   void stack_##TNAME##_push(stack_##TNAME##_t *stack, T item);                 \
   T stack_##TNAME##_pop(stack_##TNAME##_t *stack);                             \
   T stack_##TNAME##_top(stack_##TNAME##_t *stack);                             \
-  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);
+  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);                        \
+  void stack_##TNAME##_dispose(stack_##TNAME##_t *stack);
 
 STACKDEC(bst_node_t *, bst)
 STACKDEC(bool, bool)
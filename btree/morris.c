@@ -0,0 +1,151 @@
+/*
+ * Průchody a zrušení stromu bez zásobníku a bez rekurze
+ *
+ * Při překladu s -DBST_MORRIS (make MORRIS=1) nahrazují průchody a zrušení
+ * stromu z variant rec a iter. Kromě pole uzlů nepotřebují žádnou paměť
+ * navíc, takže projdou i strom s hloubkou v řádu milionů uzlů. Průchody
+ * dočasně mění ukazatele right (Morrisovy průchody) a před skončením je
+ * vrátí, strom proto nesmí během průchodu nikdo jiný číst.
+ */
+
+#include "btree.h"
+#include <stdlib.h>
+
+#ifdef BST_MORRIS
+
+// Gets the in-order predecessor of the node that has a left subtree. The
+// right pointer of the predecessor is either NULL or the thread back to the
+// node, created by the traversal.
+static bst_node_t *bst_predecessor(bst_node_t *tree) {
+  bst_node_t *pred = tree->left;
+  while (pred->right && pred->right != tree) {
+    pred = pred->right;
+  }
+  return pred;
+}
+
+// Reverses the list of nodes linked by the right pointers, returns the new
+// first node
+static bst_node_t *bst_reverse_right(bst_node_t *list) {
+  bst_node_t *prev = NULL;
+  while (list) {
+    bst_node_t *next = list->right;
+    list->right = prev;
+    prev = list;
+    list = next;
+  }
+  return prev;
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Uzel s levým podstromem se rotuje doprava, dokud levý podstrom nemá,
+ * potom se uvolní a pokračuje se jeho pravým podstromem. Každá rotace
+ * přesune jeden uzel z levé větve, takže funkce je lineární.
+ */
+void bst_dispose(bst_node_t **tree) {
+  bst_node_t *t = *tree;
+  while (t) {
+    if (t->left) {
+      bst_node_t *l = t->left;
+      t->left = l->right;
+      l->right = t;
+      t = l;
+    } else {
+      bst_node_t *next = t->right;
+      free(t);
+      t = next;
+    }
+  }
+  *tree = NULL;
+}
+
+/*
+ * Preorder průchod stromem.
+ *
+ * Před sestupem do levého podstromu se jeho nejpravější uzel propojí zpět
+ * na aktuální uzel, po návratu přes toto propojení se propojení zruší.
+ */
+void bst_preorder(bst_node_t *tree, bst_items_t *items) {
+  while (tree) {
+    if (!tree->left) {
+      bst_add_node_to_items(tree, items);
+      tree = tree->right;
+      continue;
+    }
+
+    bst_node_t *pred = bst_predecessor(tree);
+    if (!pred->right) {
+      // first visit, add the node and go left
+      bst_add_node_to_items(tree, items);
+      pred->right = tree;
+      tree = tree->left;
+    } else {
+      // back from the left subtree
+      pred->right = NULL;
+      tree = tree->right;
+    }
+  }
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Stejně jako preorder, jen se uzel přidá až po návratu z levého podstromu.
+ */
+void bst_inorder(bst_node_t *tree, bst_items_t *items) {
+  while (tree) {
+    if (!tree->left) {
+      bst_add_node_to_items(tree, items);
+      tree = tree->right;
+      continue;
+    }
+
+    bst_node_t *pred = bst_predecessor(tree);
+    if (!pred->right) {
+      pred->right = tree;
+      tree = tree->left;
+    } else {
+      pred->right = NULL;
+      bst_add_node_to_items(tree, items);
+      tree = tree->right;
+    }
+  }
+}
+
+/*
+ * Postorder průchod stromem.
+ *
+ * Průchod je inorder průchod stromu s pomocným kořenem, jehož levým
+ * podstromem je tree. Po návratu z levého podstromu uzlu se přidá pravá
+ * větev od jeho levého potomka k předchůdci v opačném pořadí. Větev se na
+ * to dočasně otočí, aby nebyla potřeba další paměť.
+ */
+void bst_postorder(bst_node_t *tree, bst_items_t *items) {
+  bst_node_t root = {.left = tree};
+  tree = &root;
+  while (tree) {
+    if (!tree->left) {
+      tree = tree->right;
+      continue;
+    }
+
+    bst_node_t *pred = bst_predecessor(tree);
+    if (!pred->right) {
+      pred->right = tree;
+      tree = tree->left;
+      continue;
+    }
+
+    pred->right = NULL;
+    bst_node_t *branch = bst_reverse_right(tree->left);
+    for (bst_node_t *n = branch; n; n = n->right) {
+      bst_add_node_to_items(n, items);
+    }
+    bst_reverse_right(branch);
+    tree = tree->right;
+  }
+}
+
+#endif // BST_MORRIS
@@ -170,6 +170,9 @@ void bst_delete(bst_node_t **tree, char key) {
   bst_replace_by_rightmost(t, &t->left);
 }
 
+// with BST_MORRIS the traversals and dispose are in ../morris.c
+#ifndef BST_MORRIS
+
 /*
  * Zrušení celého stromu.
  *
@@ -250,3 +253,5 @@ void bst_postorder(bst_node_t *tree, bst_items_t *items) {
   bst_postorder(tree->right, items);
   bst_add_node_to_items(tree, items);
 }
+
+#endif // BST_MORRIS
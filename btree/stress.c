@@ -0,0 +1,145 @@
+/*
+ * Zátěžový test průchodů a zrušení degenerovaných stromů s velkou hloubkou.
+ * Rekurzivní průchody na nich přetečou zásobník volání, překládá se proto s
+ * -DBST_MORRIS (make stress).
+ *
+ * Klíče jsou typu char, takže tak hluboký strom nejde vytvořit vkládáním.
+ * Uzly se proto propojí ručně do řetězce a hodnota uzlu je jeho pořadí v
+ * řetězci.
+ *
+ * Použití: ./stress [hloubka stromu]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "btree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Shapes of the chain, whether the next node is the left child
+typedef enum shape { SHAPE_RIGHT, SHAPE_LEFT, SHAPE_ZIGZAG } shape_t;
+
+static int errors;
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static bool goes_left(shape_t shape, int i) {
+  return shape == SHAPE_LEFT || (shape == SHAPE_ZIGZAG && i % 2);
+}
+
+// Creates the chain of `depth` nodes, returns NULL on failure
+static bst_node_t *make_chain(shape_t shape, int depth) {
+  bst_node_t *root = NULL;
+  bst_node_t **link = &root;
+  for (int i = 0; i < depth; ++i) {
+    bst_node_t *node = calloc(1, sizeof(*node));
+    if (!node) {
+      bst_dispose(&root);
+      return NULL;
+    }
+    node->value = i;
+    *link = node;
+    link = goes_left(shape, i) ? &node->left : &node->right;
+  }
+  return root;
+}
+
+// Checks the values of the items against the expected order
+static void check(const char *name, bst_items_t *items, const int *expected,
+                  int depth, long long time) {
+  bool ok = items->size == depth;
+  for (int i = 0; ok && i < depth; ++i) {
+    ok = items->nodes[i]->value == expected[i];
+  }
+  printf("%-10s %8.1f ms %s\n", name, time / 1e6, ok ? "ok" : "WRONG");
+  errors += !ok;
+  items->size = 0;
+}
+
+static void stress_shape(const char *name, shape_t shape, int depth,
+                         int *expected) {
+  printf("%s chain, depth %d\n", name, depth);
+  bst_node_t *tree = make_chain(shape, depth);
+  if (!tree) {
+    printf("Failed to allocate the tree\n");
+    ++errors;
+    return;
+  }
+  bst_items_t items = {NULL, 0, 0};
+
+  // the chain has one node on each level, preorder is the chain itself
+  for (int i = 0; i < depth; ++i) {
+    expected[i] = i;
+  }
+  long long start = now_ns();
+  bst_preorder(tree, &items);
+  check("preorder", &items, expected, depth, now_ns() - start);
+
+  // nodes are in inorder after their left subtree and before the right
+  int front = 0;
+  int back = depth - 1;
+  for (int i = 0; i < depth - 1; ++i) {
+    if (goes_left(shape, i)) {
+      expected[back--] = i;
+    } else {
+      expected[front++] = i;
+    }
+  }
+  expected[front] = depth - 1;
+  start = now_ns();
+  bst_inorder(tree, &items);
+  check("inorder", &items, expected, depth, now_ns() - start);
+
+  for (int i = 0; i < depth; ++i) {
+    expected[i] = depth - 1 - i;
+  }
+  start = now_ns();
+  bst_postorder(tree, &items);
+  check("postorder", &items, expected, depth, now_ns() - start);
+
+  // the traversals must restore all the links, the second preorder fails
+  // otherwise
+  for (int i = 0; i < depth; ++i) {
+    expected[i] = i;
+  }
+  start = now_ns();
+  bst_preorder(tree, &items);
+  check("restored", &items, expected, depth, now_ns() - start);
+
+  start = now_ns();
+  bst_dispose(&tree);
+  printf("%-10s %8.1f ms %s\n", "dispose", (now_ns() - start) / 1e6,
+         tree ? "WRONG" : "ok");
+  errors += tree != NULL;
+  free(items.nodes);
+}
+
+int main(int argc, char *argv[]) {
+  int depth = argc > 1 ? atoi(argv[1]) : 10000000;
+  if (depth <= 0) {
+    fprintf(stderr, "Invalid depth\n");
+    return 1;
+  }
+  int *expected = malloc(depth * sizeof(*expected));
+  if (!expected) {
+    fprintf(stderr, "Failed to allocate the expected order\n");
+    return 1;
+  }
+
+  stress_shape("Right", SHAPE_RIGHT, depth, expected);
+  stress_shape("Left", SHAPE_LEFT, depth, expected);
+  stress_shape("Zigzag", SHAPE_ZIGZAG, depth, expected);
+  free(expected);
+
+  if (errors) {
+    printf("\x1b[91m%d ERRORS\x1b[0m\n", errors);
+    return 1;
+  }
+  printf("\x1b[92mALL PASS\x1b[0m\n");
+}
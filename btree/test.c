@@ -210,7 +210,12 @@ TEST(test_tree_preorder, "Traverse the tree using preorder")
   bst_preorder(test_tree, test_items);
   bst_print_tree(test_tree);
   bst_print_items(test_items);
+#ifdef BST_AVL
+  // inserting A rotates D down to the right of B
+  int expected[] = { 2, 3, 1, 4, 5 };
+#else
   int expected[] = { 1, 2, 3, 4, 5 };
+#endif
   success = test_items->size == traversal_data_count;
   for (size_t i = 0; i < test_items->size; ++i) {
     success &= test_items->nodes[i]->value == expected[i];
@@ -237,13 +242,78 @@ TEST(test_tree_postorder, "Traverse the tree using postorder")
   bst_postorder(test_tree, test_items);
   bst_print_tree(test_tree);
   bst_print_items(test_items);
+#ifdef BST_AVL
+  int expected[] = { 3, 4, 5, 1, 2 };
+#else
   int expected[] = { 3, 4, 2, 5, 1 };
+#endif
   success = test_items->size == traversal_data_count;
   for (size_t i = 0; i < test_items->size; ++i) {
     success &= test_items->nodes[i]->value == expected[i];
   }
 ENDTEST
 
+TEST(test_tree_deep, "Traverse and dispose a degenerate tree of all keys")
+  bst_init(&test_tree);
+  for (int key = CHAR_MIN; key <= CHAR_MAX; ++key) {
+    bst_insert(&test_tree, key, key);
+  }
+  // deeper than any fixed traversal stack, nodes must not be dropped
+  bst_inorder(test_tree, test_items);
+  success &= test_items->size == CHAR_MAX - CHAR_MIN + 1;
+  for (int i = 0; i < test_items->size; ++i) {
+    success &= test_items->nodes[i]->key == CHAR_MIN + i;
+  }
+  test_items->size = 0;
+  bst_preorder(test_tree, test_items);
+  success &= test_items->size == CHAR_MAX - CHAR_MIN + 1;
+  test_items->size = 0;
+  bst_postorder(test_tree, test_items);
+  success &= test_items->size == CHAR_MAX - CHAR_MIN + 1;
+ENDTEST
+
+#ifdef BST_AVL
+
+// Gets height of the tree, -1 if some node has wrong height or its subtrees
+// differ in height by more than one
+int avl_check(bst_node_t *tree) {
+  if (!tree) {
+    return 0;
+  }
+  int left = avl_check(tree->left);
+  int right = avl_check(tree->right);
+  int height = (left > right ? left : right) + 1;
+  if (left < 0 || right < 0 || abs(left - right) > 1 ||
+      tree->height != height) {
+    return -1;
+  }
+  return height;
+}
+
+TEST(test_tree_avl_sorted, "Keep the tree balanced with sorted keys")
+  bst_init(&test_tree);
+  for (char key = 'A'; key <= 'Z'; ++key) {
+    bst_insert(&test_tree, key, key - 'A');
+    success &= avl_check(test_tree) > 0;
+  }
+  bst_print_tree(test_tree);
+  // 26 nodes fit into a perfect tree with height 5
+  success &= avl_check(test_tree) <= 6;
+
+  for (char key = 'A'; key <= 'Z'; key += 2) {
+    bst_delete(&test_tree, key);
+    success &= avl_check(test_tree) > 0;
+  }
+  bst_print_tree(test_tree);
+  for (char key = 'A'; key <= 'Z'; ++key) {
+    int res;
+    bool found = bst_search(test_tree, key, &res);
+    success &= (key - 'A') % 2 ? found && res == key - 'A' : !found;
+  }
+ENDTEST
+
+#endif // BST_AVL
+
 #ifdef EXA
 
 TEST(test_letter_count, "Count letters");
@@ -285,6 +355,10 @@ int main(int argc, char *argv[]) {
   success &= test_tree_preorder();
   success &= test_tree_inorder();
   success &= test_tree_postorder();
+  success &= test_tree_deep();
+#ifdef BST_AVL
+  success &= test_tree_avl_sorted();
+#endif
 
   if (success) {
     printf("\x1b[92mALL PASS\x1b[0m\n");
@@ -0,0 +1,745 @@
+/*
+ * Měření výkonu tabulky s rozptýlenými položkami.
+ *
+ * Použití: ./bench [počet klíčů]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "frozen.h"
+#include "hashtable.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KEY_LEN 16
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+  long long x = *(const long long *)a;
+  long long y = *(const long long *)b;
+  return (x > y) - (x < y);
+}
+
+// Gets the `p`-th percentile from sorted array
+static long long percentile(const long long *sorted, int count, double p) {
+  int i = (int)(p / 100 * (count - 1));
+  return sorted[i];
+}
+
+// Measures latency of each insert into table with the given rehash budget
+static void bench_insert_latency(char (*keys)[KEY_LEN], int count,
+                                 int budget) {
+  long long *times = malloc(count * sizeof(*times));
+  if (!times) {
+    return;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+#ifdef HT_CHAINED
+  table.rehash_budget = budget;
+#endif
+
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    long long t = now_ns();
+    ht_insert(&table, keys[i], i);
+    times[i] = now_ns() - t;
+  }
+  long long total = now_ns() - start;
+
+  ht_dispose(&table);
+
+  qsort(times, count, sizeof(*times), cmp_ll);
+  printf("%6d %10.1f %8lld %8lld %8lld %10lld\n", budget,
+         (double)total / count, percentile(times, count, 50),
+         percentile(times, count, 99), percentile(times, count, 99.9),
+         times[count - 1]);
+
+  free(times);
+}
+
+// Shuffles the keys, so that lookups don't follow the order of allocation
+static void shuffle(char **keys, int count) {
+  uint64_t rnd = 88172645463325252ull;
+  for (int i = count - 1; i > 0; --i) {
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 7;
+    rnd ^= rnd << 17;
+    int j = rnd % (i + 1);
+    char *tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+// Measures average time of successful and unsuccessful lookups
+static void bench_lookup(char (*keys)[KEY_LEN], int count) {
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  char miss[KEY_LEN];
+  float sum = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_get(&table, keys[i]);
+  }
+  long long hit = now_ns() - start;
+
+  start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    snprintf(miss, KEY_LEN, "miss%d", i);
+    sum += ht_get(&table, miss) != NULL;
+  }
+  long long missed = now_ns() - start;
+
+  ht_dispose(&table);
+
+  printf("%10.1f %10.1f (%g)\n", (double)hit / count, (double)missed / count,
+         sum);
+}
+
+// Measures latency of each lookup in random order, when the table is filled
+// to the given load factor and doesn't grow
+static void bench_load_latency(char (*keys)[KEY_LEN], int count, float load) {
+  char **order = malloc(count * sizeof(*order));
+  long long *times = malloc(count * sizeof(*times));
+  if (!order || !times) {
+    free(order);
+    free(times);
+    return;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  ht_resize(&table, count);
+  table.max_load = 0;
+  // the engines round the size differently
+  int n = table.size * load < count ? table.size * load : count;
+  for (int i = 0; i < n; ++i) {
+    ht_insert(&table, keys[i], i);
+    order[i] = keys[i];
+  }
+  shuffle(order, n);
+
+  float sum = 0;
+  for (int i = 0; i < n; ++i) {
+    long long t = now_ns();
+    sum += *ht_get(&table, order[i]);
+    times[i] = now_ns() - t;
+  }
+  float real_load = (float)table.count / table.size;
+
+  ht_dispose(&table);
+  free(order);
+
+  qsort(times, n, sizeof(*times), cmp_ll);
+  printf("%6.2f %8lld %8lld %8lld %10lld (%g)\n", real_load,
+         percentile(times, n, 50), percentile(times, n, 99),
+         percentile(times, n, 99.9), times[n - 1], sum);
+  free(times);
+}
+
+// Measures lookups in random order with ht_get in loop and with ht_get_batch
+static void bench_batch(char (*keys)[KEY_LEN], int count) {
+  const int batch = 1024;
+  char **order = malloc(count * sizeof(*order));
+  float **values = malloc(batch * sizeof(*values));
+  if (!order || !values) {
+    free(order);
+    free(values);
+    return;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+    order[i] = keys[i];
+  }
+  shuffle(order, count);
+
+  float sum = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_get(&table, order[i]);
+  }
+  long long loop = now_ns() - start;
+
+  start = now_ns();
+  for (int i = 0; i < count; i += batch) {
+    int n = count - i < batch ? count - i : batch;
+    ht_get_batch(&table, order + i, n, values);
+    for (int j = 0; j < n; ++j) {
+      sum += *values[j];
+    }
+  }
+  long long batched = now_ns() - start;
+
+  ht_dispose(&table);
+  free(order);
+  free(values);
+
+  printf("%10.2f %10.2f (%g)\n", count / (loop / 1e3), count / (batched / 1e3),
+         sum);
+}
+
+// Compares startup by inserting all the keys with startup by mapping saved
+// snapshot, followed by lookup of all the keys
+static void bench_snapshot(char (*keys)[KEY_LEN], int count) {
+  const char *path = "bench.snapshot";
+  ht_table_t table;
+  ht_init(&table);
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+  long long insert = now_ns() - start;
+
+  start = now_ns();
+  bool saved = ht_snapshot_save(&table, path);
+  long long save = now_ns() - start;
+  ht_dispose(&table);
+
+  ht_snapshot_t snapshot;
+  start = now_ns();
+  if (!saved || !ht_snapshot_open(&snapshot, path)) {
+    fprintf(stderr, "Failed to save or open snapshot\n");
+    remove(path);
+    return;
+  }
+  long long open = now_ns() - start;
+
+  float sum = 0;
+  start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_snapshot_get(&snapshot, keys[i]);
+  }
+  long long lookup = now_ns() - start;
+
+  ht_snapshot_close(&snapshot);
+  remove(path);
+
+  printf("%10.1f %10.1f %10.3f %10.1f (%g)\n", insert / 1e6, save / 1e6,
+         open / 1e6, lookup / 1e6, sum);
+}
+
+// Gets the memory used by the table without the keys, the allocator
+// overhead is not counted
+static size_t table_memory(ht_table_t *table) {
+#if defined(HT_SWISS)
+  return table->size * (sizeof(*table->slots) + sizeof(*table->ctrl));
+#elif defined(HT_CUCKOO)
+  return table->size * (sizeof(*table->slots) + sizeof(*table->tags)) +
+         table->stash_size * sizeof(*table->stash);
+#else
+  return table->size * sizeof(*table->items) +
+         table->count * sizeof(ht_item_t);
+#endif
+}
+
+// Compares memory and random order lookups of the table with its frozen copy
+static void bench_frozen(char (*keys)[KEY_LEN], int count) {
+  char **order = malloc(count * sizeof(*order));
+  if (!order) {
+    return;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  size_t keys_size = 0;
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+    order[i] = keys[i];
+    keys_size += strlen(keys[i]) + 1;
+  }
+  shuffle(order, count);
+
+  float sum = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_get(&table, order[i]);
+  }
+  long long live = now_ns() - start;
+
+  ht_frozen_t frozen;
+  start = now_ns();
+  bool ok = ht_freeze(&table, &frozen);
+  long long freeze = now_ns() - start;
+  // the keys of the table are counted too, the frozen table has its own
+  double table_bytes = (double)(table_memory(&table) + keys_size) / count;
+  ht_dispose(&table);
+  if (!ok) {
+    fprintf(stderr, "Failed to freeze the table\n");
+    free(order);
+    return;
+  }
+
+  start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_frozen_get(&frozen, order[i]);
+  }
+  long long frozen_time = now_ns() - start;
+
+  printf("%10.1f %10.1f %10.2f %10.2f %10.1f (%g)\n", table_bytes,
+         (double)frozen.data_size / count, count / (live / 1e3),
+         count / (frozen_time / 1e3), freeze / 1e6, sum);
+
+  ht_frozen_dispose(&frozen);
+  free(order);
+}
+
+// Number of hashes or comparisons measured for each key length
+#define KEY_OPS (1 << 20)
+
+// Longest key measured by bench_key_lengths
+#define MAX_KEY_LEN 1024
+
+// Measures hashing and comparing of keys with the given length. The keys
+// start at different unaligned offsets of `data`, which has two copies of
+// the same bytes, so that the compared keys are equal.
+static void bench_key_length(const char *data, size_t length) {
+  static const ht_hash_fn_t hashes[] = {ht_hash_fnv1a, ht_hash_wy};
+  uint64_t sum = 0;
+  printf("%6zu", length);
+
+  for (size_t h = 0; h < sizeof(hashes) / sizeof(*hashes); ++h) {
+    long long start = now_ns();
+    for (int i = 0; i < KEY_OPS; ++i) {
+      sum += hashes[h](data + i % 61, length, i);
+    }
+    printf(" %8.2f", (double)(now_ns() - start) / KEY_OPS);
+  }
+  for (ht_simd_t simd = HT_SIMD_SCALAR; simd <= HT_SIMD_AVX2; ++simd) {
+    long long start = now_ns();
+    for (int i = 0; i < KEY_OPS; ++i) {
+      sum += ht_hash_vec_simd(data + i % 61, length, i, simd);
+    }
+    printf(" %8.2f", (double)(now_ns() - start) / KEY_OPS);
+  }
+
+  const char *copy = data + MAX_KEY_LEN + 64;
+  long long start = now_ns();
+  for (int i = 0; i < KEY_OPS; ++i) {
+    sum += memcmp(data + i % 61, copy + i % 61, length) == 0;
+  }
+  printf(" %8.2f", (double)(now_ns() - start) / KEY_OPS);
+  for (ht_simd_t simd = HT_SIMD_SCALAR; simd <= HT_SIMD_AVX2; ++simd) {
+    long long start = now_ns();
+    for (int i = 0; i < KEY_OPS; ++i) {
+      sum += ht_key_equal_simd(data + i % 61, copy + i % 61, length, simd);
+    }
+    printf(" %8.2f", (double)(now_ns() - start) / KEY_OPS);
+  }
+  printf(" (%llu)\n", (unsigned long long)sum % 1000);
+}
+
+// Measures hashing and comparing of keys for lengths from 8 to MAX_KEY_LEN
+static void bench_key_lengths(void) {
+  char *data = malloc(2 * (MAX_KEY_LEN + 64));
+  if (!data) {
+    return;
+  }
+  for (int i = 0; i < MAX_KEY_LEN + 64; ++i) {
+    data[i] = data[i + MAX_KEY_LEN + 64] = 'a' + i * 7 % 26;
+  }
+
+  static const size_t lengths[] = {8, 16, 24, 32, 48, 64, 128, 256, 1024};
+  for (size_t i = 0; i < sizeof(lengths) / sizeof(*lengths); ++i) {
+    bench_key_length(data, lengths[i]);
+  }
+  free(data);
+}
+
+#ifdef HT_CHAINED
+
+// Measures inserts and ht_delete_all with items allocated from slab with
+// `block_count` items per block (0 for malloc)
+static void bench_slab(char (*keys)[KEY_LEN], int count, int block_count) {
+  ht_table_t table;
+  ht_init(&table);
+  ht_use_slab(&table, block_count);
+
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+  long long insert = now_ns() - start;
+  long mallocs = table.slab.mallocs;
+
+  start = now_ns();
+  ht_delete_all(&table);
+  long long delete_all = now_ns() - start;
+
+  printf("%6d %10.1f %10ld %10.3f\n", block_count, (double)insert / count,
+         mallocs, delete_all / 1e6);
+
+  ht_dispose(&table);
+}
+
+// Measures random lookups of records with `value_size` bytes, once stored
+// in separate array with their index in the table and once stored directly
+// in the table items
+static void bench_values(char (*keys)[KEY_LEN], int count, size_t value_size) {
+  char *records = malloc(count * value_size);
+  char **order = malloc(count * sizeof(*order));
+  if (!records || !order) {
+    free(records);
+    free(order);
+    return;
+  }
+  for (int i = 0; i < count; ++i) {
+    memset(records + i * value_size, i, value_size);
+    order[i] = keys[i];
+  }
+  shuffle(order, count);
+
+  ht_table_t table;
+  ht_init(&table);
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+  uint64_t sum = 0;
+  uint64_t field;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    int index = *ht_get(&table, order[i]);
+    memcpy(&field, records + index * value_size, sizeof(field));
+    sum += field;
+  }
+  long long indexed = now_ns() - start;
+  ht_dispose(&table);
+
+  ht_init(&table);
+  ht_use_values(&table, value_size);
+  for (int i = 0; i < count; ++i) {
+    ht_insert_value(&table, keys[i], records + i * value_size);
+  }
+  start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    memcpy(&field, ht_get_value(&table, order[i]), sizeof(field));
+    sum += field;
+  }
+  long long inline_values = now_ns() - start;
+  ht_dispose(&table);
+
+  free(records);
+  free(order);
+
+  printf("%6zu %10.1f %10.1f (%llu)\n", value_size, (double)indexed / count,
+         (double)inline_values / count, (unsigned long long)sum);
+}
+
+// Gets number of bytes read by strcmp of the strings
+static size_t strcmp_bytes(const char *a, const char *b) {
+  size_t i = 0;
+  while (a[i] && a[i] == b[i]) {
+    ++i;
+  }
+  return i + 1;
+}
+
+// Measures lookups of long keys with shared prefix on table with long chains
+// and counts how many key bytes would be compared by strcmp on each synonym
+// and how many are compared when the hash and length are checked first
+static void bench_prefix_keys(int count) {
+  const int key_len = 48;
+  char (*keys)[48] = malloc(count * sizeof(*keys));
+  if (!keys) {
+    return;
+  }
+  for (int i = 0; i < count; ++i) {
+    snprintf(keys[i], key_len, "Binance Coin Wrapped Staked Token #%07d", i);
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  // keep about 8 items in each chain
+  ht_resize(&table, count / 8 + 1);
+  table.max_load = 0;
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+
+  long long strcmp_total = 0;
+  long long hashed_total = 0;
+  for (int i = 0; i < count; ++i) {
+    size_t length = strlen(keys[i]);
+    uint64_t hash = ht_key_hash(&table, keys[i], length);
+    for (ht_item_t *item = table.items[hash % table.size]; item;
+         item = item->next) {
+      strcmp_total += strcmp_bytes(keys[i], item->key);
+      if (item->hash == hash && item->length == length) {
+        hashed_total += length;
+      }
+      if (item->key == keys[i]) {
+        break;
+      }
+    }
+  }
+
+  float sum = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += *ht_get(&table, keys[i]);
+  }
+  long long time = now_ns() - start;
+
+  ht_dispose(&table);
+  free(keys);
+
+  printf("%10.1f %10.1f %10.1f (%g)\n", (double)strcmp_total / count,
+         (double)hashed_total / count, (double)time / count, sum);
+}
+
+// Generates `n` indexes of keys from Zipf distribution with exponent 1, so
+// the i-th most frequent key is looked up about 1/i as often as the first.
+// Ranks are assigned to the keys randomly.
+static int *zipf_indexes(int count, int n) {
+  double *cdf = malloc(count * sizeof(*cdf));
+  int *ranks = malloc(count * sizeof(*ranks));
+  int *indexes = malloc(n * sizeof(*indexes));
+  if (!cdf || !ranks || !indexes) {
+    free(cdf);
+    free(ranks);
+    free(indexes);
+    return NULL;
+  }
+
+  double sum = 0;
+  for (int i = 0; i < count; ++i) {
+    sum += 1.0 / (i + 1);
+    cdf[i] = sum;
+    ranks[i] = i;
+  }
+
+  uint64_t rnd = 0x9e3779b97f4a7c15ull;
+  for (int i = count - 1; i > 0; --i) {
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 7;
+    rnd ^= rnd << 17;
+    int j = rnd % (i + 1);
+    int tmp = ranks[i];
+    ranks[i] = ranks[j];
+    ranks[j] = tmp;
+  }
+
+  for (int i = 0; i < n; ++i) {
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 7;
+    rnd ^= rnd << 17;
+    double u = (rnd >> 11) * 0x1p-53 * sum;
+    // first rank with cdf at least u
+    int lo = 0;
+    int hi = count - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cdf[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    indexes[i] = ranks[lo];
+  }
+
+  free(cdf);
+  free(ranks);
+  return indexes;
+}
+
+// Measures the average number of items visited by ht_search and the time of
+// lookups with Zipfian distribution, when the chains are reordered with the
+// given mode
+static void bench_reorder(char (*keys)[KEY_LEN], int count, const int *zipf,
+                          ht_reorder_t reorder, const char *name) {
+  ht_table_t table;
+  ht_init(&table);
+  // keep about 8 items in each chain, so that the order matters
+  ht_resize(&table, count / 8 + 1);
+  table.max_load = 0;
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+  }
+  table.reorder = reorder;
+
+  // the items before the found one are visited too
+  long long visited = 0;
+  for (int i = 0; i < count; ++i) {
+    char *key = keys[zipf[i]];
+    ht_item_t *item = table.items[ht_key_hash(&table, key, strlen(key)) %
+                                  table.size];
+    for (; item->key != key; item = item->next) {
+      ++visited;
+    }
+    ++visited;
+    ht_search(&table, key);
+  }
+
+  float sum = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    sum += ht_search(&table, keys[zipf[i]])->value;
+  }
+  long long time = now_ns() - start;
+
+  ht_dispose(&table);
+
+  printf("%10s %10.2f %10.1f (%g)\n", name, (double)visited / count,
+         (double)time / count, sum);
+}
+
+// Measures lookups where 9 of 10 keys are missing, with filter of the keys
+// with the given false positive rate (0 without filter). The keys are not
+// shuffled, so that only the table is read in random order.
+static void bench_filter(char (*keys)[KEY_LEN], int count, float fp_rate) {
+  char (*missing)[KEY_LEN] = malloc(count * sizeof(*missing));
+  char **order = malloc(count * sizeof(*order));
+  if (!missing || !order) {
+    free(missing);
+    free(order);
+    return;
+  }
+
+  ht_table_t table;
+  ht_init(&table);
+  ht_use_filter(&table, fp_rate);
+  for (int i = 0; i < count; ++i) {
+    ht_insert(&table, keys[i], i);
+    snprintf(missing[i], KEY_LEN, "miss%d", i);
+    order[i] = i % 10 ? missing[i] : keys[i];
+  }
+
+  int found = 0;
+  long long start = now_ns();
+  for (int i = 0; i < count; ++i) {
+    found += ht_search(&table, order[i]) != NULL;
+  }
+  long long time = now_ns() - start;
+
+  // misses that the filter didn't reject
+  int passed = 0;
+  for (int i = 0; i < count; ++i) {
+    passed += ht_filter_may_contain(
+        &table.filter, ht_key_hash(&table, missing[i], strlen(missing[i])));
+  }
+
+  printf("%10g %10.1f %10.2f %10.4f (%d)\n", fp_rate, (double)time / count,
+         (double)ht_filter_memory(&table.filter) / table.count,
+         (double)passed / count, found);
+  ht_dispose(&table);
+  free(missing);
+  free(order);
+}
+
+#endif // HT_CHAINED
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (count <= 0) {
+    fprintf(stderr, "Invalid number of keys\n");
+    return 1;
+  }
+
+  char (*keys)[KEY_LEN] = malloc(count * sizeof(*keys));
+  if (!keys) {
+    fprintf(stderr, "Failed to allocate keys\n");
+    return 1;
+  }
+  for (int i = 0; i < count; ++i) {
+    snprintf(keys[i], KEY_LEN, "key%d", i);
+  }
+
+  printf("Insert latency of %d keys [ns]\n", count);
+  printf("%6s %10s %8s %8s %8s %10s\n", "budget", "avg", "p50", "p99",
+         "p99.9", "max");
+#ifdef HT_CHAINED
+  int budgets[] = {0, 1, 4, 16};
+#else
+  int budgets[] = {0};
+#endif
+  for (size_t i = 0; i < sizeof(budgets) / sizeof(*budgets); ++i) {
+    bench_insert_latency(keys, count, budgets[i]);
+  }
+
+  printf("\nLookup time [ns]\n");
+  printf("%10s %10s\n", "hit", "miss");
+  bench_lookup(keys, count);
+
+  printf("\nLookup latency at high load [ns]\n");
+  printf("%6s %8s %8s %8s %10s\n", "load", "p50", "p99", "p99.9", "max");
+  float loads[] = {0.5f, 0.75f, 0.9f, 0.95f};
+  for (size_t i = 0; i < sizeof(loads) / sizeof(*loads); ++i) {
+    bench_load_latency(keys, count, loads[i]);
+  }
+
+  printf("\nRandom order lookups [M/s]\n");
+  printf("%10s %10s\n", "ht_get", "batch");
+  bench_batch(keys, count);
+
+  printf("\nStartup [ms]\n");
+  printf("%10s %10s %10s %10s\n", "insert", "save", "open", "lookups");
+  bench_snapshot(keys, count);
+
+  printf("\nFrozen table\n");
+  printf("%10s %10s %10s %10s %10s\n", "table B", "frozen B", "table M/s",
+         "frozen M/s", "freeze ms");
+  bench_frozen(keys, count);
+
+  printf("\nHashing and comparing keys by length [ns], best SIMD: %s\n",
+         (const char *[]){"scalar", "sse2", "avx2"}[ht_simd_best()]);
+  printf("%6s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "length", "fnv1a",
+         "wy", "vec", "vec sse2", "vec avx2", "memcmp", "equal", "eq sse2",
+         "eq avx2");
+  bench_key_lengths();
+
+#ifdef HT_CHAINED
+  printf("\nItem allocation\n");
+  printf("%6s %10s %10s %10s\n", "block", "insert ns", "mallocs",
+         "delete ms");
+  bench_slab(keys, count, 0);
+  bench_slab(keys, count, 4096);
+
+  printf("\nRecord lookups [ns]\n");
+  printf("%6s %10s %10s\n", "bytes", "indexed", "inline");
+  bench_values(keys, count, 8);
+  bench_values(keys, count, 32);
+  bench_values(keys, count, 128);
+
+  printf("\nLong keys with shared prefix\n");
+  printf("%10s %10s %10s\n", "strcmp B", "hashed B", "lookup ns");
+  bench_prefix_keys(count);
+
+  int *zipf = zipf_indexes(count, count);
+  if (zipf) {
+    printf("\nZipfian lookups with reordered chains\n");
+    printf("%10s %10s %10s\n", "reorder", "visited", "lookup ns");
+    bench_reorder(keys, count, zipf, HT_REORDER_NONE, "none");
+    bench_reorder(keys, count, zipf, HT_REORDER_TRANSPOSE, "transpose");
+    bench_reorder(keys, count, zipf, HT_REORDER_FRONT, "front");
+    free(zipf);
+  }
+
+  printf("\nLookups with 90%% missing keys\n");
+  printf("%10s %10s %10s %10s\n", "fp target", "lookup ns", "filter B",
+         "fp rate");
+  bench_filter(keys, count, 0);
+  bench_filter(keys, count, 0.1f);
+  bench_filter(keys, count, 0.01f);
+  bench_filter(keys, count, 0.001f);
+#endif
+
+  free(keys);
+}
@@ -0,0 +1,138 @@
+/*
+ * Měření výkonu tabulky sdílené mezi vlákny.
+ *
+ * Použití: ./bench_mt [počet klíčů] [maximální počet vláken]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KEY_LEN 16
+
+// Number of operations done by each thread
+#define THREAD_OPS 1000000
+
+// Work of one thread
+typedef struct bench_thread {
+  pthread_t thread;
+  ht_concurrent_t *table;
+  char (*keys)[KEY_LEN];
+  int count;     // number of keys
+  int read_pct;  // percentage of operations that are lookups
+  uint64_t rnd;  // state of the random generator
+} bench_thread_t;
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static uint64_t xorshift(uint64_t *rnd) {
+  *rnd ^= *rnd << 13;
+  *rnd ^= *rnd >> 7;
+  *rnd ^= *rnd << 17;
+  return *rnd;
+}
+
+// Does random lookups, inserts and deletes of the keys
+static void *bench_worker(void *arg) {
+  bench_thread_t *t = arg;
+  for (int i = 0; i < THREAD_OPS; ++i) {
+    uint64_t r = xorshift(&t->rnd);
+    char *key = t->keys[r % t->count];
+    int op = (r >> 32) % 100;
+    if (op < t->read_pct) {
+      float value;
+      htc_get(t->table, key, &value);
+    } else if (op % 2) {
+      htc_insert(t->table, key, i);
+    } else {
+      htc_delete(t->table, key);
+    }
+  }
+  return NULL;
+}
+
+// Measures throughput of `threads` threads with the given share of lookups
+// in millions of operations per second. With `locked` the readers take the
+// stripe locks instead of using the epoch.
+static double bench_mixed(char (*keys)[KEY_LEN], int count, int threads,
+                          int read_pct, bool locked) {
+  bench_thread_t *work = malloc(threads * sizeof(*work));
+  if (!work) {
+    return 0;
+  }
+
+  ht_concurrent_t table;
+  if (!htc_init(&table, ht_hash_wy, 0)) {
+    free(work);
+    return 0;
+  }
+  table.locked_reads = locked;
+  for (int i = 0; i < count; ++i) {
+    htc_insert(&table, keys[i], i);
+  }
+
+  long long start = now_ns();
+  for (int i = 0; i < threads; ++i) {
+    work[i].table = &table;
+    work[i].keys = keys;
+    work[i].count = count;
+    work[i].read_pct = read_pct;
+    work[i].rnd = 88172645463325252ull + i * 0x9e3779b97f4a7c15ull;
+    pthread_create(&work[i].thread, NULL, bench_worker, &work[i]);
+  }
+  for (int i = 0; i < threads; ++i) {
+    pthread_join(work[i].thread, NULL);
+  }
+  long long time = now_ns() - start;
+
+  htc_dispose(&table);
+  free(work);
+
+  return (double)threads * THREAD_OPS / (time / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 100000;
+  int max_threads = argc > 2 ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (count <= 0 || max_threads <= 0) {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  char (*keys)[KEY_LEN] = malloc(count * sizeof(*keys));
+  if (!keys) {
+    fprintf(stderr, "Failed to allocate keys\n");
+    return 1;
+  }
+  for (int i = 0; i < count; ++i) {
+    snprintf(keys[i], KEY_LEN, "key%d", i);
+  }
+
+  printf("Mixed operations on %d keys [M/s]\n", count);
+  printf("%8s %9s %10s %10s\n", "threads", "reads", "locked", "epoch");
+  int read_pcts[] = {50, 90, 99, 100};
+  for (size_t r = 0; r < sizeof(read_pcts) / sizeof(*read_pcts); ++r) {
+    for (int threads = 1;; threads *= 2) {
+      if (threads > max_threads) {
+        threads = max_threads;
+      }
+      printf("%8d %8d%% %10.2f %10.2f\n", threads, read_pcts[r],
+             bench_mixed(keys, count, threads, read_pcts[r], true),
+             bench_mixed(keys, count, threads, read_pcts[r], false));
+      if (threads == max_threads) {
+        break;
+      }
+    }
+  }
+
+  free(keys);
+}
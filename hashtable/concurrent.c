@@ -0,0 +1,341 @@
+/*
+ * Tabulka s rozptýlenými položkami sdílená mezi vlákny.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent.h"
+#include "epoch.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Gets the smallest prime that is at least `n`
+static int htc_next_prime(int n) {
+  if (n <= 2) {
+    return 2;
+  }
+  for (n |= 1;; n += 2) {
+    int d = 3;
+    for (; d * d <= n && n % d; d += 2)
+      ;
+    if (d * d > n) {
+      return n;
+    }
+  }
+}
+
+// Allocates empty bucket array with the given size
+static htc_buckets_t *htc_alloc_buckets(int size) {
+  htc_buckets_t *buckets =
+      malloc(sizeof(*buckets) + size * sizeof(*buckets->items));
+  if (!buckets) {
+    return NULL;
+  }
+  buckets->size = size;
+  for (int i = 0; i < size; ++i) {
+    atomic_init(&buckets->items[i], NULL);
+  }
+  return buckets;
+}
+
+// Initializes the table to use the given hash function. Returns false on
+// allocation failure.
+bool htc_init(ht_concurrent_t *table, ht_hash_fn_t hash, uint64_t seed) {
+  htc_buckets_t *buckets = htc_alloc_buckets(MAX_HT_SIZE);
+  table->stripes = aligned_alloc(_Alignof(htc_stripe_t),
+                                 HTC_STRIPES * sizeof(*table->stripes));
+  if (!buckets || !table->stripes) {
+    free(buckets);
+    free(table->stripes);
+    atomic_init(&table->buckets, NULL);
+    table->stripes = NULL;
+    return false;
+  }
+
+  for (int i = 0; i < HTC_STRIPES; ++i) {
+    pthread_rwlock_init(&table->stripes[i].lock, NULL);
+  }
+  atomic_init(&table->buckets, buckets);
+  atomic_init(&table->size, MAX_HT_SIZE);
+  atomic_init(&table->count, 0);
+  table->max_load = HT_MAX_LOAD;
+  table->locked_reads = false;
+  table->hash = hash;
+  table->seed = seed;
+  return true;
+}
+
+// Locks the stripe of the bucket where the hash belongs and returns pointer
+// to the bucket. Writers may not dereference the buckets before they hold
+// the lock, because growing can free them, so the stripe is chosen by
+// `size`, which is checked again under the lock.
+static _Atomic(htc_item_t *) *htc_lock(ht_concurrent_t *table, uint64_t hash,
+                                       bool write) {
+  for (;;) {
+    int size = atomic_load_explicit(&table->size, memory_order_relaxed);
+    int index = hash % size;
+    pthread_rwlock_t *lock = &table->stripes[index % HTC_STRIPES].lock;
+    if (write) {
+      pthread_rwlock_wrlock(lock);
+    } else {
+      pthread_rwlock_rdlock(lock);
+    }
+    htc_buckets_t *buckets =
+        atomic_load_explicit(&table->buckets, memory_order_relaxed);
+    if (buckets->size == size) {
+      return &buckets->items[index];
+    }
+    pthread_rwlock_unlock(lock);
+  }
+}
+
+static void htc_unlock(ht_concurrent_t *table, uint64_t hash) {
+  int index =
+      hash % atomic_load_explicit(&table->size, memory_order_relaxed);
+  pthread_rwlock_unlock(&table->stripes[index % HTC_STRIPES].lock);
+}
+
+// Gets the item with the key from the bucket, NULL if there is none
+static htc_item_t *htc_find(_Atomic(htc_item_t *) *bucket, const char *key,
+                            size_t length, uint64_t hash) {
+  htc_item_t *item = atomic_load_explicit(bucket, memory_order_acquire);
+  for (; item;
+       item = atomic_load_explicit(&item->next, memory_order_acquire)) {
+    if (item->hash == hash && item->length == length &&
+        memcmp(key, item->key, length) == 0) {
+      return item;
+    }
+  }
+  return NULL;
+}
+
+// Gets pointer to position of item with the key in the bucket. If the key is
+// not in the bucket, the position is at the end of the chain. Only for
+// writers, the position may change without the stripe lock.
+static _Atomic(htc_item_t *) *htc_find_pos(_Atomic(htc_item_t *) *pos,
+                                           const char *key, size_t length,
+                                           uint64_t hash) {
+  htc_item_t *item;
+  while ((item = atomic_load_explicit(pos, memory_order_relaxed))) {
+    if (item->hash == hash && item->length == length &&
+        memcmp(key, item->key, length) == 0) {
+      return pos;
+    }
+    pos = &item->next;
+  }
+  return pos;
+}
+
+// Gets the value of the key into `value`. Returns false if the key is not in
+// the table.
+bool htc_get(ht_concurrent_t *table, const char *key, float *value) {
+  size_t length = strlen(key);
+  uint64_t hash = table->hash(key, length, table->seed);
+
+  if (!table->locked_reads && ht_epoch_enter()) {
+    htc_buckets_t *buckets =
+        atomic_load_explicit(&table->buckets, memory_order_acquire);
+    _Atomic(htc_item_t *) *bucket = &buckets->items[hash % buckets->size];
+    htc_item_t *item = htc_find(bucket, key, length, hash);
+    if (item) {
+      *value = item->value;
+    }
+    ht_epoch_leave();
+    return item != NULL;
+  }
+
+  _Atomic(htc_item_t *) *bucket = htc_lock(table, hash, false);
+  htc_item_t *item = htc_find(bucket, key, length, hash);
+  if (item) {
+    *value = item->value;
+  }
+  htc_unlock(table, hash);
+
+  return item != NULL;
+}
+
+// Allocates new item, returns NULL on failure
+static htc_item_t *htc_new_item(char *key, float value, size_t length,
+                                uint64_t hash, htc_item_t *next) {
+  htc_item_t *item = malloc(sizeof(*item));
+  if (!item) {
+    return NULL;
+  }
+  item->key = key;
+  item->value = value;
+  item->length = length;
+  item->hash = hash;
+  atomic_init(&item->next, next);
+  return item;
+}
+
+// Rehashes the table to twice the size if it is still overloaded once all
+// the stripes are locked. Readers may still walk the old chains, so the
+// items are copied and the old ones are retired.
+static void htc_grow(ht_concurrent_t *table) {
+  // always lock in the same order, so that two resizes can't deadlock
+  for (int i = 0; i < HTC_STRIPES; ++i) {
+    pthread_rwlock_wrlock(&table->stripes[i].lock);
+  }
+
+  htc_buckets_t *old =
+      atomic_load_explicit(&table->buckets, memory_order_relaxed);
+  int count = atomic_load_explicit(&table->count, memory_order_relaxed);
+  htc_buckets_t *buckets = NULL;
+  if (count > old->size * table->max_load) {
+    buckets = htc_alloc_buckets(htc_next_prime(old->size * 2));
+  }
+
+  for (int i = 0; buckets && i < old->size; ++i) {
+    htc_item_t *item =
+        atomic_load_explicit(&old->items[i], memory_order_relaxed);
+    for (; item;
+         item = atomic_load_explicit(&item->next, memory_order_relaxed)) {
+      _Atomic(htc_item_t *) *bucket =
+          &buckets->items[item->hash % buckets->size];
+      htc_item_t *copy = htc_new_item(
+          item->key, item->value, item->length, item->hash,
+          atomic_load_explicit(bucket, memory_order_relaxed));
+      if (!copy) {
+        // keep the old buckets, readers haven't seen the new ones yet
+        htc_buckets_t *failed = buckets;
+        buckets = NULL;
+        for (int j = 0; j < failed->size; ++j) {
+          htc_item_t *c =
+              atomic_load_explicit(&failed->items[j], memory_order_relaxed);
+          while (c) {
+            htc_item_t *next =
+                atomic_load_explicit(&c->next, memory_order_relaxed);
+            free(c);
+            c = next;
+          }
+        }
+        free(failed);
+        break;
+      }
+      atomic_store_explicit(bucket, copy, memory_order_relaxed);
+    }
+  }
+
+  if (buckets) {
+    atomic_store_explicit(&table->buckets, buckets, memory_order_release);
+    atomic_store_explicit(&table->size, buckets->size, memory_order_relaxed);
+  }
+
+  for (int i = HTC_STRIPES - 1; i >= 0; --i) {
+    pthread_rwlock_unlock(&table->stripes[i].lock);
+  }
+
+  // writers use only the new buckets now, so the old ones don't change
+  if (buckets) {
+    for (int i = 0; i < old->size; ++i) {
+      htc_item_t *item =
+          atomic_load_explicit(&old->items[i], memory_order_relaxed);
+      while (item) {
+        htc_item_t *next =
+            atomic_load_explicit(&item->next, memory_order_relaxed);
+        ht_epoch_retire(item);
+        item = next;
+      }
+    }
+    ht_epoch_retire(old);
+  }
+}
+
+// Inserts the key or updates its value. The table keeps only pointer to the
+// key, so it must live until it is deleted.
+void htc_insert(ht_concurrent_t *table, char *key, float value) {
+  size_t length = strlen(key);
+  uint64_t hash = table->hash(key, length, table->seed);
+
+  _Atomic(htc_item_t *) *pos =
+      htc_find_pos(htc_lock(table, hash, true), key, length, hash);
+  htc_item_t *old = atomic_load_explicit(pos, memory_order_relaxed);
+  htc_item_t *item = htc_new_item(
+      key, value, length, hash,
+      old ? atomic_load_explicit(&old->next, memory_order_relaxed) : NULL);
+  if (!item) {
+    htc_unlock(table, hash);
+    return;
+  }
+
+  // readers see either the old or the new item, never a half written one
+  atomic_store_explicit(pos, item, memory_order_release);
+  int count = 0;
+  if (!old) {
+    count = atomic_fetch_add_explicit(&table->count, 1,
+                                      memory_order_relaxed) + 1;
+  }
+  htc_unlock(table, hash);
+
+  if (old) {
+    ht_epoch_retire(old);
+  } else if (table->max_load &&
+             count > atomic_load_explicit(&table->size,
+                                          memory_order_relaxed) *
+                         table->max_load) {
+    htc_grow(table);
+  }
+}
+
+// Removes the key from the table
+void htc_delete(ht_concurrent_t *table, const char *key) {
+  size_t length = strlen(key);
+  uint64_t hash = table->hash(key, length, table->seed);
+
+  _Atomic(htc_item_t *) *pos =
+      htc_find_pos(htc_lock(table, hash, true), key, length, hash);
+  htc_item_t *item = atomic_load_explicit(pos, memory_order_relaxed);
+  if (item) {
+    // the removed item still points to the rest of the chain, so readers
+    // standing on it can continue
+    atomic_store_explicit(
+        pos, atomic_load_explicit(&item->next, memory_order_relaxed),
+        memory_order_release);
+    atomic_fetch_sub_explicit(&table->count, 1, memory_order_relaxed);
+  }
+  htc_unlock(table, hash);
+
+  if (item) {
+    ht_epoch_retire(item);
+  }
+}
+
+// Removes all the items. Must not run at the same time as other operations
+// on the table.
+void htc_delete_all(ht_concurrent_t *table) {
+  htc_buckets_t *buckets =
+      atomic_load_explicit(&table->buckets, memory_order_relaxed);
+  for (int i = 0; i < buckets->size; ++i) {
+    htc_item_t *item =
+        atomic_load_explicit(&buckets->items[i], memory_order_relaxed);
+    while (item) {
+      htc_item_t *next =
+          atomic_load_explicit(&item->next, memory_order_relaxed);
+      free(item);
+      item = next;
+    }
+    atomic_store_explicit(&buckets->items[i], NULL, memory_order_relaxed);
+  }
+  atomic_store_explicit(&table->count, 0, memory_order_relaxed);
+}
+
+// Frees all the memory of the table, including the retired items. Must not
+// run at the same time as other operations on the table.
+void htc_dispose(ht_concurrent_t *table) {
+  htc_buckets_t *buckets =
+      atomic_load_explicit(&table->buckets, memory_order_relaxed);
+  if (!buckets) {
+    return;
+  }
+  htc_delete_all(table);
+  for (int i = 0; i < HTC_STRIPES; ++i) {
+    pthread_rwlock_destroy(&table->stripes[i].lock);
+  }
+  free(buckets);
+  free(table->stripes);
+  atomic_store_explicit(&table->buckets, NULL, memory_order_relaxed);
+  atomic_store_explicit(&table->size, 0, memory_order_relaxed);
+  table->stripes = NULL;
+  ht_epoch_synchronize();
+}
@@ -0,0 +1,68 @@
+/*
+ * Tabulka s rozptýlenými položkami sdílená mezi vlákny.
+ */
+
+#ifndef IAL_HASHTABLE_CONCURRENT_H
+#define IAL_HASHTABLE_CONCURRENT_H
+
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Number of locks in the table, bucket `i` is guarded by lock
+// `i % HTC_STRIPES`
+#define HTC_STRIPES 64
+
+// Lock on its own cache line, so that threads using different stripes don't
+// slow each other down
+typedef struct htc_stripe {
+  _Alignas(64) pthread_rwlock_t lock;
+} htc_stripe_t;
+
+// Item of the concurrent table. Only `next` changes after the item is
+// published, updated values are written to a new copy of the item.
+typedef struct htc_item {
+  char *key;                       // kľúč prvku
+  float value;                     // hodnota prvku
+  uint32_t length;                 // dĺžka kľúča
+  _Atomic(struct htc_item *) next; // ukazateľ na ďalšie synonymum
+  uint64_t hash;                   // celý hash kľúča
+} htc_item_t;
+
+// Bucket array, replaced as a whole when the table grows
+typedef struct htc_buckets {
+  int size;                      // počet zoznamov synonym
+  _Atomic(htc_item_t *) items[]; // zoznamy synonym
+} htc_buckets_t;
+
+/*
+ * Chained hash table that can be used from multiple threads at once.
+ * Writers lock the stripe of the bucket, growing locks all the stripes.
+ *
+ * Readers don't lock anything, they are protected by epoch based
+ * reclamation: removed items and old bucket arrays are freed only after
+ * all the readers that could see them leave the epoch. With `locked_reads`
+ * readers take the stripe lock for reading instead.
+ *
+ * Items are never returned by pointer, because other thread could delete
+ * them, htc_get copies the value instead.
+ */
+typedef struct ht_concurrent {
+  _Atomic(htc_buckets_t *) buckets; // zoznamy synonym
+  _Atomic int size;                 // počet zoznamov synonym pre zapisovačov
+  atomic_int count;                 // počet prvkov v tabuľke
+  float max_load;        // pri prekročení count / size sa tabuľka zväčší
+  bool locked_reads;     // čitatelia zamykajú namiesto epoch
+  htc_stripe_t *stripes; // zámky pre zoznamy synonym
+  ht_hash_fn_t hash;     // rozptylovacia funkcia
+  uint64_t seed;         // seed pre rozptylovaciu funkciu
+} ht_concurrent_t;
+
+bool htc_init(ht_concurrent_t *table, ht_hash_fn_t hash, uint64_t seed);
+bool htc_get(ht_concurrent_t *table, const char *key, float *value);
+void htc_insert(ht_concurrent_t *table, char *key, float value);
+void htc_delete(ht_concurrent_t *table, const char *key);
+void htc_delete_all(ht_concurrent_t *table);
+void htc_dispose(ht_concurrent_t *table);
+
+#endif
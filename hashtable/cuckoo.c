@@ -0,0 +1,603 @@
+/*
+ * Tabulka s rozptýlenými položkami — kukaččí hašování
+ *
+ * Implementace rozhraní ze souboru hashtable.h, ve které může být každý klíč
+ * jen v jednom ze dvou košů se čtyřmi místy. Vyhledání tak prochází nejvýše
+ * dva koše a malý zásobník prvků, které se nepodařilo umístit. Překládá se
+ * s -DHT_CUCKOO místo souboru hashtable.c.
+ */
+
+#include "hashtable.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Number of keys processed together by the batch functions
+#define BATCH_GROUP 16
+
+// Hint to the CPU to start loading the memory
+#ifdef __GNUC__
+#define PREFETCH(ADDR) __builtin_prefetch(ADDR)
+#else
+#define PREFETCH(ADDR) ((void)(ADDR))
+#endif
+
+// Maximum number of items moved to their other bucket by one insert, the
+// last moved item goes to the stash
+#define MAX_KICKS 512
+
+// The table grows when there are more items in the stash, because the
+// lookups of keys that are not in the table go through all of them
+#define MAX_STASH 8
+
+int HT_SIZE = MAX_HT_SIZE;
+
+/*
+ * Rozptylovací funkce která přidělí zadanému klíči index z intervalu
+ * <0,HT_SIZE-1>. Ideální rozptylovací funkce by měla rozprostírat klíče
+ * rovnoměrně po všech indexech. Zamyslete sa nad kvalitou zvolené funkce.
+ */
+int get_hash(char *key) {
+  int result = 1;
+  int length = strlen(key);
+  for (int i = 0; i < length; i++) {
+    result += key[i];
+  }
+  return (result % HT_SIZE);
+}
+
+// Gets the hash of key as used by the table, so that it can be passed to the
+// *_hashed functions
+uint64_t ht_key_hash(ht_table_t *table, const char *key, size_t length) {
+  return table->hash(key, length, table->seed);
+}
+
+// Gets the tag of the hash stored for each slot, 0 is for empty slots
+static uint8_t ht_tag(uint64_t hash) {
+  uint8_t tag = hash >> 56;
+  return tag ? tag : 1;
+}
+
+// Gets the first bucket where the hash can be
+static int ht_bucket1(ht_table_t *table, uint64_t hash) {
+  return hash & (table->size / HT_CUCKOO_SLOTS - 1);
+}
+
+// Gets the second bucket where the hash can be, it is always different from
+// the first one
+static int ht_bucket2(ht_table_t *table, uint64_t hash) {
+  int mask = table->size / HT_CUCKOO_SLOTS - 1;
+  int bucket = (hash >> 32) & mask;
+  return bucket == (int)(hash & mask) ? bucket ^ 1 : bucket;
+}
+
+// Checks whether the item has the key with the given length and hash
+static bool ht_item_is(ht_item_t *item, const char *key, size_t length,
+                       uint64_t hash) {
+  return item->hash == hash && item->length == length &&
+         memcmp(key, item->key, length) == 0;
+}
+
+// Gets the item with index `i`, indexes from size continue in the stash
+static ht_item_t *ht_item_at(ht_table_t *table, int i) {
+  return i < table->size ? &table->slots[i] : &table->stash[i - table->size];
+}
+
+// Gets the smallest valid table size that is not smaller than `size`, there
+// are always at least two buckets
+static int ht_round_size(int size) {
+  int result = 2 * HT_CUCKOO_SLOTS;
+  while (result < size) {
+    result *= 2;
+  }
+  return result;
+}
+
+// Allocates empty arrays with the given size, on failure the table has size
+// 0 and false is returned
+static bool ht_alloc(ht_table_t *table, int size) {
+  // items are aligned to cache lines, so that reading one loads one line
+  table->slots = aligned_alloc(64, size * sizeof(*table->slots));
+  table->tags = calloc(size, sizeof(*table->tags));
+  table->stash = NULL;
+  table->stash_count = 0;
+  table->stash_size = 0;
+  table->count = 0;
+
+  if (!table->slots || !table->tags) {
+    free(table->slots);
+    free(table->tags);
+    table->slots = NULL;
+    table->tags = NULL;
+    table->size = 0;
+    return false;
+  }
+
+  table->size = size;
+  return true;
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_hash(table, ht_hash_wy, 0);
+}
+
+// Initializes the table to use the given hash function
+void ht_init_hash(ht_table_t *table, ht_hash_fn_t hash, uint64_t seed) {
+  table->min_size = ht_round_size(HT_SIZE);
+  table->max_load = HT_CUCKOO_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+  table->hash = hash;
+  table->seed = seed;
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+  ht_alloc(table, table->min_size);
+}
+
+// Gets index of the item with the key (see ht_item_at), -1 if the key is not
+// in the table. Only the slots with matching tag are read.
+static int ht_find(ht_table_t *table, const char *key, size_t length,
+                   uint64_t hash) {
+  uint8_t tag = ht_tag(hash);
+  int buckets[] = {ht_bucket1(table, hash), ht_bucket2(table, hash)};
+
+  for (int b = 0; b < 2; ++b) {
+    HT_COUNT(table, visited, 1);
+    int first = buckets[b] * HT_CUCKOO_SLOTS;
+    for (int i = first; i < first + HT_CUCKOO_SLOTS; ++i) {
+      if (table->tags[i] == tag &&
+          ht_item_is(&table->slots[i], key, length, hash)) {
+        return i;
+      }
+    }
+  }
+
+  if (table->stash_count) {
+    HT_COUNT(table, visited, 1);
+  }
+  for (int i = 0; i < table->stash_count; ++i) {
+    if (ht_item_is(&table->stash[i], key, length, hash)) {
+      return table->size + i;
+    }
+  }
+
+  return -1;
+}
+
+// Gets index of free slot in the bucket, -1 if the bucket is full
+static int ht_bucket_free(ht_table_t *table, int bucket) {
+  int first = bucket * HT_CUCKOO_SLOTS;
+  for (int i = first; i < first + HT_CUCKOO_SLOTS; ++i) {
+    if (!table->tags[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Makes sure there is space for one more item in the stash
+static bool ht_stash_reserve(ht_table_t *table) {
+  if (table->stash_count < table->stash_size) {
+    return true;
+  }
+  int size = table->stash_size ? table->stash_size * 2 : MAX_STASH;
+  ht_item_t *stash = realloc(table->stash, size * sizeof(*stash));
+  if (!stash) {
+    return false;
+  }
+  table->stash = stash;
+  table->stash_size = size;
+  return true;
+}
+
+// Stores the item to the slot with index `i`
+static void ht_put(ht_table_t *table, int i, const ht_item_t *item) {
+  table->slots[i] = *item;
+  table->tags[i] = ht_tag(item->hash);
+}
+
+// Places the item to one of its buckets. If both are full, items are moved
+// to their other bucket to make space and the item that is left without
+// slot goes to the stash. Returns false if the stash can't grow, the table
+// is unchanged in that case.
+static bool ht_place(ht_table_t *table, ht_item_t item) {
+  // reserve first, so that no moved item can be lost
+  if (!ht_stash_reserve(table)) {
+    return false;
+  }
+
+  int bucket = ht_bucket1(table, item.hash);
+  int i = ht_bucket_free(table, bucket);
+  if (i < 0) {
+    bucket = ht_bucket2(table, item.hash);
+    i = ht_bucket_free(table, bucket);
+  }
+
+  for (int kick = 0; i < 0 && kick < MAX_KICKS; ++kick) {
+    // swap with item in the full bucket, the choice depends on the item in
+    // hand so that the same two items aren't swapped over and over
+    int victim = bucket * HT_CUCKOO_SLOTS +
+                 ((item.hash >> 40) + kick) % HT_CUCKOO_SLOTS;
+    ht_item_t moved = table->slots[victim];
+    ht_put(table, victim, &item);
+    item = moved;
+
+    int first = ht_bucket1(table, item.hash);
+    bucket = bucket == first ? ht_bucket2(table, item.hash) : first;
+    i = ht_bucket_free(table, bucket);
+  }
+
+  if (i < 0) {
+    table->stash[table->stash_count++] = item;
+  } else {
+    ht_put(table, i, &item);
+  }
+  return true;
+}
+
+// Moves all the items to new arrays with at least the given size. If the
+// allocation fails, the table is left unchanged and false is returned.
+bool ht_resize(ht_table_t *table, int size) {
+  ht_table_t old = *table;
+
+  // keep at least one free slot
+  size = ht_round_size(size > old.count ? size : old.count + 1);
+  if (!ht_alloc(table, size)) {
+    *table = old;
+    return false;
+  }
+
+  for (int i = 0; i < old.size + old.stash_count; ++i) {
+    if (i < old.size && !old.tags[i]) {
+      continue;
+    }
+    if (!ht_place(table, *ht_item_at(&old, i))) {
+      free(table->slots);
+      free(table->tags);
+      free(table->stash);
+      *table = old;
+      return false;
+    }
+  }
+  table->count = old.count;
+  HT_COUNT(table, rehashes, 1);
+
+  free(old.slots);
+  free(old.tags);
+  free(old.stash);
+  return true;
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  size_t length = strlen(key);
+  return ht_search_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Same as ht_search, but with already known length and hash of the key
+ht_item_t *ht_search_hashed(ht_table_t *table, const char *key, size_t length,
+                            uint64_t hash) {
+  if (!table->size) {
+    return NULL;
+  }
+
+  int i = ht_find(table, key, length, hash);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, i >= 0);
+  HT_COUNT(table, misses, i < 0);
+  return i < 0 ? NULL : ht_item_at(table, i);
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahraďte jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  size_t length = strlen(key);
+  ht_insert_hashed(table, key, length, ht_key_hash(table, key, length),
+                   value);
+}
+
+// Same as ht_insert, but with already known length and hash of the key. The
+// key must be null-terminated.
+void ht_insert_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash, float value) {
+  if (!table->size) {
+    return;
+  }
+
+  int i = ht_find(table, key, length, hash);
+
+  if (i >= 0) {
+    // modify existing
+    ht_item_at(table, i)->value = value;
+    return;
+  }
+
+  if (table->max_load && table->count + 1 > table->size * table->max_load) {
+    ht_resize(table, table->size * 2);
+  }
+
+  ht_item_t item = {(char *)key, value, length, NULL, hash};
+  if (!ht_place(table, item)) {
+    return;
+  }
+  ++table->count;
+  HT_COUNT(table, inserts, 1);
+
+  // full stash means the buckets are too crowded, unless most of the keys
+  // have the same hash, then growing wouldn't help
+  if (table->stash_count > MAX_STASH && table->count > table->size / 2) {
+    ht_resize(table, table->size * 2);
+  }
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *i = ht_search(table, key);
+  return i ? &i->value : NULL;
+}
+
+// Same as ht_get, but with already known length and hash of the key
+float *ht_get_hashed(ht_table_t *table, const char *key, size_t length,
+                     uint64_t hash) {
+  ht_item_t *i = ht_search_hashed(table, key, length, hash);
+  return i ? &i->value : NULL;
+}
+
+// Removes the item with index `i`. The last item of the stash takes place
+// of removed stash item.
+static void ht_remove(ht_table_t *table, int i) {
+  if (i < table->size) {
+    table->tags[i] = 0;
+  } else {
+    table->stash[i - table->size] = table->stash[--table->stash_count];
+  }
+  --table->count;
+  HT_COUNT(table, deletes, 1);
+}
+
+// Moves an item from the stash to the bucket, which has free slot now
+static void ht_unstash(ht_table_t *table, int bucket) {
+  for (int i = 0; i < table->stash_count; ++i) {
+    uint64_t hash = table->stash[i].hash;
+    if (ht_bucket1(table, hash) == bucket ||
+        ht_bucket2(table, hash) == bucket) {
+      ht_put(table, ht_bucket_free(table, bucket), &table->stash[i]);
+      table->stash[i] = table->stash[--table->stash_count];
+      return;
+    }
+  }
+}
+
+// Shrinks the table if there are too few items
+static void ht_shrink_sparse(ht_table_t *table) {
+  // shrink so that the memory is released after mass delete
+  if (table->min_load && table->size > table->min_size &&
+      table->count < table->size * table->min_load) {
+    ht_resize(table, table->size / 2);
+  }
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  size_t length = strlen(key);
+  ht_delete_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Same as ht_delete, but with already known length and hash of the key
+void ht_delete_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash) {
+  if (!table->size) {
+    return;
+  }
+
+  int i = ht_find(table, key, length, hash);
+  if (i < 0) {
+    return;
+  }
+
+  ht_remove(table, i);
+  if (i < table->size) {
+    ht_unstash(table, i / HT_CUCKOO_SLOTS);
+  }
+  ht_shrink_sparse(table);
+}
+
+// Starts loading the tags of both buckets of the hash
+static void ht_prefetch_buckets(ht_table_t *table, uint64_t hash) {
+  if (table->size) {
+    PREFETCH(table->tags + ht_bucket1(table, hash) * HT_CUCKOO_SLOTS);
+    PREFETCH(table->tags + ht_bucket2(table, hash) * HT_CUCKOO_SLOTS);
+  }
+}
+
+// Stores the result of ht_get for keys[i] to values[i]. The memory loads
+// for multiple keys overlap, so it is faster than calling ht_get in loop.
+void ht_get_batch(ht_table_t *table, char *keys[], int n, float *values[]) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    // hash the keys and start loading their buckets
+    for (int j = 0; j < group; ++j) {
+      lengths[j] = strlen(keys[i + j]);
+      hashes[j] = ht_key_hash(table, keys[i + j], lengths[j]);
+      ht_prefetch_buckets(table, hashes[j]);
+    }
+
+    for (int j = 0; j < group; ++j) {
+      values[i + j] = ht_get_hashed(table, keys[i + j], lengths[j], hashes[j]);
+    }
+  }
+}
+
+// Same as calling ht_insert for all the pairs keys[i], values[i]
+void ht_insert_batch(ht_table_t *table, char *keys[], float values[], int n) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    for (int j = 0; j < group; ++j) {
+      lengths[j] = strlen(keys[i + j]);
+      hashes[j] = ht_key_hash(table, keys[i + j], lengths[j]);
+      ht_prefetch_buckets(table, hashes[j]);
+    }
+
+    for (int j = 0; j < group; ++j) {
+      ht_insert_hashed(table, keys[i + j], lengths[j], hashes[j],
+                       values[i + j]);
+    }
+  }
+}
+
+// Starts iteration over the items of the table
+void ht_iter_begin(ht_table_t *table, ht_iter_t *iter) {
+  iter->table = table;
+  iter->slot = -1;
+}
+
+// Gets the next item of the iteration, NULL if there are no more items
+ht_item_t *ht_iter_next(ht_iter_t *iter) {
+  ht_table_t *table = iter->table;
+  while (++iter->slot < table->size) {
+    if (table->tags[iter->slot]) {
+      return &table->slots[iter->slot];
+    }
+  }
+  if (iter->slot < table->size + table->stash_count) {
+    return &table->stash[iter->slot - table->size];
+  }
+  iter->slot = table->size + table->stash_count;
+  return NULL;
+}
+
+// Deletes the item last returned by ht_iter_next
+void ht_iter_delete(ht_iter_t *iter) {
+  ht_table_t *table = iter->table;
+  if (iter->slot < 0 || iter->slot >= table->size + table->stash_count) {
+    return;
+  }
+  if (iter->slot >= table->size) {
+    ht_remove(table, iter->slot);
+    // the last item of the stash moved here and wasn't returned yet
+    --iter->slot;
+  } else if (table->tags[iter->slot]) {
+    ht_remove(table, iter->slot);
+  }
+}
+
+// Calls `visit` for all the items until it returns false
+void ht_for_each(ht_table_t *table, ht_visit_fn_t visit, void *ctx) {
+  for (int i = 0; i < table->size; ++i) {
+    if (table->tags[i] && !visit(&table->slots[i], ctx)) {
+      return;
+    }
+  }
+  for (int i = 0; i < table->stash_count; ++i) {
+    if (!visit(&table->stash[i], ctx)) {
+      return;
+    }
+  }
+}
+
+// Deletes all the items for which `pred` returns true, returns the number of
+// deleted items
+int ht_delete_if(ht_table_t *table, ht_visit_fn_t pred, void *ctx) {
+  int count = table->count;
+  ht_iter_t iter;
+  ht_iter_begin(table, &iter);
+  for (ht_item_t *item; (item = ht_iter_next(&iter));) {
+    if (pred(item, ctx)) {
+      ht_iter_delete(&iter);
+    }
+  }
+
+  // the table can shrink only after the iteration
+  if (count != table->count) {
+    ht_shrink_sparse(table);
+  }
+  return count - table->count;
+}
+
+// Gets the counters and the current shape of the table. The histogram
+// counts the items in their first bucket (1), in the second bucket (2) and
+// in the stash (3).
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->size = table->size;
+  stats->count = table->count;
+  stats->load = table->size ? (float)table->count / table->size : 0;
+
+  for (int i = 0; i < table->size; ++i) {
+    if (table->tags[i]) {
+      int first = ht_bucket1(table, table->slots[i].hash);
+      ++stats->histogram[i / HT_CUCKOO_SLOTS == first ? 1 : 2];
+    }
+  }
+  stats->histogram[3] = table->stash_count;
+  for (int i = 1; i < 4; ++i) {
+    if (stats->histogram[i]) {
+      stats->max_chain = i;
+    }
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvede tabulku do stavu po inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table->size > table->min_size) {
+    free(table->slots);
+    free(table->tags);
+    free(table->stash);
+    ht_alloc(table, table->min_size);
+    return;
+  }
+
+  if (table->size) {
+    memset(table->tags, 0, table->size);
+  }
+  table->count = 0;
+  table->stash_count = 0;
+}
+
+// Frees the arrays. The table must be initialized again before it is used.
+void ht_dispose(ht_table_t *table) {
+  free(table->slots);
+  free(table->tags);
+  free(table->stash);
+  table->slots = NULL;
+  table->tags = NULL;
+  table->stash = NULL;
+  table->size = 0;
+  table->count = 0;
+  table->stash_count = 0;
+  table->stash_size = 0;
+}
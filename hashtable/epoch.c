@@ -0,0 +1,157 @@
+/*
+ * Uvolňování paměti sdílené mezi vlákny podle epoch.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "epoch.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Epoch announced by one thread, 0 if the thread is not in the epoch. Each
+// slot has its own cache line, so that readers don't share any lines.
+typedef struct ht_epoch_slot {
+  _Alignas(64) _Atomic uint64_t epoch;
+  atomic_bool used; // the slot belongs to some thread
+} ht_epoch_slot_t;
+
+// Pointers retired in one epoch
+typedef struct ht_limbo {
+  void **ptrs;
+  size_t count;
+  size_t capacity;
+} ht_limbo_t;
+
+// The global epoch starts at 1, so that 0 means inactive slot
+static _Alignas(64) _Atomic uint64_t global_epoch = 1;
+static ht_epoch_slot_t slots[HT_EPOCH_THREADS];
+
+// Pointers retired in the last three epochs, indexed by epoch % 3. Guarded
+// by `limbo_lock`.
+static ht_limbo_t limbo[3];
+static size_t retired;
+static pthread_mutex_t limbo_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Releases the slot of thread when it exits
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+static _Thread_local int thread_slot = -1;
+
+static void ht_epoch_release_slot(void *slot) {
+  atomic_store_explicit(&((ht_epoch_slot_t *)slot)->used, false,
+                        memory_order_release);
+}
+
+static void ht_epoch_create_key(void) {
+  pthread_key_create(&slot_key, ht_epoch_release_slot);
+}
+
+// Finds free slot for the calling thread, returns false if there is none
+static bool ht_epoch_register(void) {
+  pthread_once(&slot_key_once, ht_epoch_create_key);
+  for (int i = 0; i < HT_EPOCH_THREADS; ++i) {
+    bool expected = false;
+    if (atomic_compare_exchange_strong(&slots[i].used, &expected, true)) {
+      thread_slot = i;
+      pthread_setspecific(slot_key, &slots[i]);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Enters the current epoch. Returns false if there are already
+// HT_EPOCH_THREADS other threads registered, the caller must use some other
+// synchronization in that case.
+bool ht_epoch_enter(void) {
+  if (thread_slot < 0 && !ht_epoch_register()) {
+    return false;
+  }
+  uint64_t epoch = atomic_load_explicit(&global_epoch, memory_order_relaxed);
+  atomic_store_explicit(&slots[thread_slot].epoch, epoch,
+                        memory_order_relaxed);
+  // the announcement must be visible before any shared pointer is loaded
+  atomic_thread_fence(memory_order_seq_cst);
+  return true;
+}
+
+// Leaves the epoch, the thread must not use any shared pointer loaded
+// since ht_epoch_enter
+void ht_epoch_leave(void) {
+  atomic_store_explicit(&slots[thread_slot].epoch, 0, memory_order_release);
+}
+
+// Frees all pointers in the limbo list
+static void ht_limbo_free(ht_limbo_t *list) {
+  for (size_t i = 0; i < list->count; ++i) {
+    free(list->ptrs[i]);
+  }
+  list->count = 0;
+}
+
+// Moves to the next epoch if all the threads in the epoch have seen the
+// current one. Pointers retired two epochs ago can't be reached by anyone
+// and are freed. Must be called with `limbo_lock` locked.
+static bool ht_epoch_try_advance(void) {
+  uint64_t epoch = atomic_load_explicit(&global_epoch, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  for (int i = 0; i < HT_EPOCH_THREADS; ++i) {
+    uint64_t e = atomic_load_explicit(&slots[i].epoch, memory_order_acquire);
+    if (e && e != epoch) {
+      return false;
+    }
+  }
+
+  ht_limbo_free(&limbo[(epoch + 2) % 3]);
+  atomic_store_explicit(&global_epoch, epoch + 1, memory_order_release);
+  return true;
+}
+
+// Frees the pointer once no thread in the epoch can see it. The pointer must
+// already be unreachable for threads that will enter the epoch.
+void ht_epoch_retire(void *ptr) {
+  pthread_mutex_lock(&limbo_lock);
+
+  uint64_t epoch = atomic_load_explicit(&global_epoch, memory_order_relaxed);
+  ht_limbo_t *list = &limbo[epoch % 3];
+  if (list->count == list->capacity) {
+    size_t capacity = list->capacity ? list->capacity * 2 : HT_EPOCH_BATCH;
+    void **ptrs = realloc(list->ptrs, capacity * sizeof(*ptrs));
+    if (!ptrs) {
+      // no memory to remember the pointer, wait until it can be freed
+      pthread_mutex_unlock(&limbo_lock);
+      ht_epoch_synchronize();
+      free(ptr);
+      return;
+    }
+    list->ptrs = ptrs;
+    list->capacity = capacity;
+  }
+  list->ptrs[list->count++] = ptr;
+
+  if (++retired % HT_EPOCH_BATCH == 0) {
+    ht_epoch_try_advance();
+  }
+
+  pthread_mutex_unlock(&limbo_lock);
+}
+
+// Waits until all the retired pointers can be freed and frees them. Must not
+// be called from inside the epoch.
+void ht_epoch_synchronize(void) {
+  pthread_mutex_lock(&limbo_lock);
+  // after three advances nothing retired before the call is in the limbo
+  for (int advances = 0; advances < 3;) {
+    if (ht_epoch_try_advance()) {
+      ++advances;
+    } else {
+      pthread_mutex_unlock(&limbo_lock);
+      sched_yield();
+      pthread_mutex_lock(&limbo_lock);
+    }
+  }
+  pthread_mutex_unlock(&limbo_lock);
+}
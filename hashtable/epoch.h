@@ -0,0 +1,31 @@
+/*
+ * Uvolňování paměti sdílené mezi vlákny podle epoch.
+ */
+
+#ifndef IAL_HASHTABLE_EPOCH_H
+#define IAL_HASHTABLE_EPOCH_H
+
+#include <stdbool.h>
+
+// Maximum number of threads that can be in the epoch at once
+#define HT_EPOCH_THREADS 128
+
+// Number of retired pointers after which the epoch tries to advance
+#define HT_EPOCH_BATCH 64
+
+/*
+ * Epoch based reclamation. Readers of shared memory call ht_epoch_enter
+ * before they load the first shared pointer and ht_epoch_leave after they
+ * are done with it. Writers unlink the memory first and then pass it to
+ * ht_epoch_retire, which frees it once no reader that could still see it is
+ * in the epoch.
+ *
+ * Entering only stores to the slot of the calling thread, readers don't
+ * write to any memory shared with other threads.
+ */
+bool ht_epoch_enter(void);
+void ht_epoch_leave(void);
+void ht_epoch_retire(void *ptr);
+void ht_epoch_synchronize(void);
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * Filtr pro rychlé odmítnutí klíčů, které nejsou v tabulce s rozptýlenými
+ * položkami.
+ */
+
+#include "filter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Number of counters in one block
+#define BLOCK_COUNTERS (HT_FILTER_BLOCK * 2)
+
+// Largest value of the counter, counters with this value stay at it
+#define COUNTER_MAX 15
+
+// The table hash may be weak (or ignore the seed), so it is mixed again
+// before it selects the counters
+static uint64_t ht_filter_mix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  return hash ^ (hash >> 33);
+}
+
+// Gets the block of the mixed hash
+static uint8_t *ht_filter_block(const ht_filter_t *filter, uint64_t mixed) {
+  uint64_t block = ((mixed >> 32) * filter->blocks) >> 32;
+  return filter->counters + block * HT_FILTER_BLOCK;
+}
+
+// Gets index of the next counter of the hash in its block. `state` starts
+// as the mixed hash, each multiplication gives new top bits that depend on
+// all the bits of the hash.
+static int ht_filter_next(uint64_t *state) {
+  *state *= 0xd6e8feb86659fd93ull;
+  return *state >> 57;
+}
+
+static int ht_filter_get(const uint8_t *block, int i) {
+  return (block[i >> 1] >> ((i & 1) * 4)) & 0xf;
+}
+
+static void ht_filter_set(uint8_t *block, int i, int value) {
+  int shift = (i & 1) * 4;
+  block[i >> 1] = (block[i >> 1] & ~(0xf << shift)) | (value << shift);
+}
+
+// Initializes disabled filter, which contains everything
+void ht_filter_init(ht_filter_t *filter) {
+  memset(filter, 0, sizeof(*filter));
+}
+
+// Creates empty filter that has about `fp_rate` false positives when it
+// contains `capacity` hashes. With more hashes the rate grows, the filter
+// still has no false negatives. Returns false on failure.
+bool ht_filter_create(ht_filter_t *filter, int capacity, float fp_rate) {
+  ht_filter_init(filter);
+  if (fp_rate <= 0 || fp_rate >= 1 || capacity < 0) {
+    return false;
+  }
+
+  // the logarithm of 1 / fp_rate is rounded up, so that the math library is
+  // not needed
+  int log = 0;
+  for (float p = fp_rate; p < 1 && log < 24; p *= 2) {
+    ++log;
+  }
+  // optimal Bloom filter has 1.44 * log counters per key, but the number of
+  // keys in a block varies, so the blocks need more (found by measuring)
+  int per_key = log * 5 / 2 - 5;
+  if (per_key < 4) {
+    per_key = 4;
+  }
+
+  filter->blocks = ((size_t)capacity * per_key + BLOCK_COUNTERS - 1) /
+                   BLOCK_COUNTERS;
+  if (!filter->blocks) {
+    filter->blocks = 1;
+  }
+  // aligned, so that a block is really one cache line
+  filter->counters =
+      aligned_alloc(HT_FILTER_BLOCK, filter->blocks * HT_FILTER_BLOCK);
+  if (!filter->counters) {
+    filter->blocks = 0;
+    return false;
+  }
+  memset(filter->counters, 0, filter->blocks * HT_FILTER_BLOCK);
+  // with the small blocks it is better to use less than ln 2 * per_key
+  // counters for one key
+  filter->hashes = (per_key + 1) / 2;
+  filter->capacity = capacity;
+  filter->fp_rate = fp_rate;
+  return true;
+}
+
+// Adds the hash to the filter
+void ht_filter_add(ht_filter_t *filter, uint64_t hash) {
+  if (!filter->counters) {
+    return;
+  }
+  uint64_t state = ht_filter_mix(hash);
+  uint8_t *block = ht_filter_block(filter, state);
+  for (int i = 0; i < filter->hashes; ++i) {
+    int index = ht_filter_next(&state);
+    int value = ht_filter_get(block, index);
+    if (value < COUNTER_MAX) {
+      ht_filter_set(block, index, value + 1);
+    }
+  }
+}
+
+// Removes the hash added by ht_filter_add
+void ht_filter_remove(ht_filter_t *filter, uint64_t hash) {
+  if (!filter->counters) {
+    return;
+  }
+  uint64_t state = ht_filter_mix(hash);
+  uint8_t *block = ht_filter_block(filter, state);
+  for (int i = 0; i < filter->hashes; ++i) {
+    int index = ht_filter_next(&state);
+    int value = ht_filter_get(block, index);
+    // saturated counter may count more hashes than it can hold
+    if (value > 0 && value < COUNTER_MAX) {
+      ht_filter_set(block, index, value - 1);
+    }
+  }
+}
+
+// Checks whether the hash may have been added. False means that it surely
+// wasn't, true may be a false positive.
+bool ht_filter_may_contain(const ht_filter_t *filter, uint64_t hash) {
+  if (!filter->counters) {
+    return true;
+  }
+  uint64_t state = ht_filter_mix(hash);
+  const uint8_t *block = ht_filter_block(filter, state);
+  for (int i = 0; i < filter->hashes; ++i) {
+    if (!ht_filter_get(block, ht_filter_next(&state))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Removes all the hashes from the filter
+void ht_filter_clear(ht_filter_t *filter) {
+  if (filter->counters) {
+    memset(filter->counters, 0, filter->blocks * HT_FILTER_BLOCK);
+  }
+}
+
+// Gets the number of bytes used by the counters
+size_t ht_filter_memory(const ht_filter_t *filter) {
+  return filter->blocks * HT_FILTER_BLOCK;
+}
+
+// Frees the counters, the filter is disabled after it
+void ht_filter_release(ht_filter_t *filter) {
+  free(filter->counters);
+  ht_filter_init(filter);
+}
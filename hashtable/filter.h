@@ -0,0 +1,42 @@
+/*
+ * Filtr pro rychlé odmítnutí klíčů, které nejsou v tabulce s rozptýlenými
+ * položkami.
+ */
+
+#ifndef IAL_HASHTABLE_FILTER_H
+#define IAL_HASHTABLE_FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Size of one block of the filter in bytes, each byte has two counters
+#define HT_FILTER_BLOCK 64
+
+/*
+ * Counting Bloom filter over the 64-bit hashes of the keys. All the counters
+ * of one hash are in the same block of HT_FILTER_BLOCK bytes (one cache
+ * line), so a check reads only one line. The counters have 4 bits, they
+ * stop at 15 and such counter is never decremented, so removing never
+ * causes false negatives.
+ *
+ * Filter with `counters` NULL is disabled and contains everything.
+ */
+typedef struct ht_filter {
+  uint8_t *counters; // blocks of counters, two counters in each byte
+  size_t blocks;     // number of blocks
+  int hashes;        // number of counters of one hash
+  int capacity;      // number of hashes the filter is sized for
+  float fp_rate;     // target false positive rate at capacity
+} ht_filter_t;
+
+void ht_filter_init(ht_filter_t *filter);
+bool ht_filter_create(ht_filter_t *filter, int capacity, float fp_rate);
+void ht_filter_add(ht_filter_t *filter, uint64_t hash);
+void ht_filter_remove(ht_filter_t *filter, uint64_t hash);
+bool ht_filter_may_contain(const ht_filter_t *filter, uint64_t hash);
+void ht_filter_clear(ht_filter_t *filter);
+size_t ht_filter_memory(const ht_filter_t *filter);
+void ht_filter_release(ht_filter_t *filter);
+
+#endif
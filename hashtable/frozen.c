@@ -0,0 +1,233 @@
+/*
+ * Neměnná tabulka s minimální perfektní rozptylovací funkcí, vytvořená z
+ * hotové tabulky s rozptýlenými položkami.
+ */
+
+#include "frozen.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Average number of keys in one bucket, more keys per bucket take less
+// memory but longer to build
+#define BUCKET_KEYS 4
+
+// Number of seeds tried before the freeze fails, different seed is needed
+// only if two keys have the same 64-bit hash
+#define MAX_ATTEMPTS 8
+
+// Seed of the first attempt
+#define FIRST_SEED 0x6a09e667f3bcc908ull
+
+// Mixes the pilot, so that consecutive pilots move the keys to unrelated
+// positions
+static uint64_t ht_frozen_mix(uint64_t pilot) {
+  pilot *= 0x9e3779b97f4a7c15ull;
+  return pilot ^ (pilot >> 29);
+}
+
+// Gets the bucket of the hash, from its upper half
+static uint32_t ht_frozen_bucket(uint64_t hash, int buckets) {
+  return ((hash >> 32) * (uint64_t)buckets) >> 32;
+}
+
+// Gets the position of the hash in entries with the given pilot. The
+// multiplication keeps keys of one bucket from moving together with the
+// pilot, and the result is scaled to count without slow division.
+static uint32_t ht_frozen_pos(uint64_t hash, uint32_t pilot, int count) {
+  uint64_t x = (hash ^ ht_frozen_mix(pilot)) * 0xff51afd7ed558ccdull;
+  return ((x >> 32) * (uint64_t)count) >> 32;
+}
+
+// Finds pilot for each bucket, so that the hashes get distinct positions.
+// `order` and `positions` must have space for `count` values. The position
+// of hashes[i] is stored to positions[i]. Returns false if some bucket has no
+// pilot within the limit.
+static bool ht_frozen_search(const uint64_t *hashes, int count, int buckets,
+                             uint32_t *pilots, int *order, int *positions) {
+  int *start = calloc(buckets + 1, sizeof(*start));
+  int *fill = malloc(buckets * sizeof(*fill));
+  int *by_size = malloc(buckets * sizeof(*by_size));
+  bool *taken = calloc(count, sizeof(*taken));
+  bool ok = start && fill && by_size && taken;
+
+  if (ok) {
+    // counting sort of the hashes by bucket
+    for (int i = 0; i < count; ++i) {
+      ++start[ht_frozen_bucket(hashes[i], buckets) + 1];
+    }
+    int max_size = 0;
+    for (int b = 0; b < buckets; ++b) {
+      if (start[b + 1] > max_size) {
+        max_size = start[b + 1];
+      }
+      start[b + 1] += start[b];
+    }
+    memcpy(fill, start, buckets * sizeof(*fill));
+    for (int i = 0; i < count; ++i) {
+      order[fill[ht_frozen_bucket(hashes[i], buckets)]++] = i;
+    }
+
+    // the largest buckets are placed first, while most positions are free
+    int n = 0;
+    for (int size = max_size; size > 0; --size) {
+      for (int b = 0; b < buckets; ++b) {
+        if (start[b + 1] - start[b] == size) {
+          by_size[n++] = b;
+        }
+      }
+    }
+    memset(pilots, 0, buckets * sizeof(*pilots));
+
+    // single key bucket placed last needs about `count` attempts
+    uint64_t limit = 64 * (uint64_t)count + 1024;
+    // the pilots are stored in 32 bits
+    if (limit > UINT32_MAX) {
+      limit = UINT32_MAX;
+    }
+    for (int i = 0; ok && i < n; ++i) {
+      int b = by_size[i];
+      uint64_t pilot = 0;
+      for (; pilot < limit; ++pilot) {
+        int k = start[b];
+        for (; k < start[b + 1]; ++k) {
+          uint32_t pos = ht_frozen_pos(hashes[order[k]], pilot, count);
+          if (taken[pos]) {
+            break;
+          }
+          taken[pos] = true;
+        }
+        if (k == start[b + 1]) {
+          break;
+        }
+        // release the positions taken by this attempt
+        while (k-- > start[b]) {
+          taken[ht_frozen_pos(hashes[order[k]], pilot, count)] = false;
+        }
+      }
+      pilots[b] = pilot;
+      ok = pilot < limit;
+    }
+
+    for (int i = 0; ok && i < count; ++i) {
+      uint32_t b = ht_frozen_bucket(hashes[i], buckets);
+      positions[i] = ht_frozen_pos(hashes[i], pilots[b], count);
+    }
+  }
+
+  free(start);
+  free(fill);
+  free(by_size);
+  free(taken);
+  return ok;
+}
+
+// Collects pointers to all the items in the table to `items`, which must
+// have space for table->count items
+static void ht_frozen_items(ht_table_t *table, ht_item_t **items) {
+  ht_iter_t iter;
+  ht_iter_begin(table, &iter);
+  for (int n = 0; n < table->count; ++n) {
+    items[n] = ht_iter_next(&iter);
+  }
+}
+
+// Creates immutable copy of all the items in the table, that doesn't depend
+// on the table or its keys. Returns false on failure.
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen) {
+  memset(frozen, 0, sizeof(*frozen));
+#ifdef HT_CHAINED
+  // only float values are copied
+  if (table->value_size) {
+    return false;
+  }
+#endif
+
+  int count = table->count;
+  int buckets = count / BUCKET_KEYS + 1;
+  ht_item_t **items = malloc(count * sizeof(*items));
+  uint64_t *hashes = malloc(count * sizeof(*hashes));
+  int *order = malloc(count * sizeof(*order));
+  int *positions = malloc(count * sizeof(*positions));
+  bool ok = (items && hashes && order && positions) || !count;
+
+  size_t keys_size = 0;
+  if (ok) {
+    ht_frozen_items(table, items);
+    for (int i = 0; i < count; ++i) {
+      keys_size += items[i]->length + 1;
+    }
+  }
+
+  // the entries have 64-bit key offsets, so they are aligned to 8 bytes
+  size_t entries_offset = (buckets * sizeof(*frozen->pilots) + 7) / 8 * 8;
+  size_t keys_offset = entries_offset + count * sizeof(*frozen->entries);
+  frozen->data_size = keys_offset + keys_size;
+  frozen->data = ok ? malloc(frozen->data_size) : NULL;
+  ok = frozen->data != NULL;
+
+  // the table hash may not separate the keys (or ignore the seed), so the
+  // keys are hashed again
+  uint32_t *pilots = frozen->data;
+  bool placed = !count;
+  for (int attempt = 0; ok && !placed && attempt < MAX_ATTEMPTS; ++attempt) {
+    frozen->seed = FIRST_SEED + attempt;
+    for (int i = 0; i < count; ++i) {
+      hashes[i] = ht_hash_wy(items[i]->key, items[i]->length, frozen->seed);
+    }
+    placed =
+        ht_frozen_search(hashes, count, buckets, pilots, order, positions);
+  }
+
+  if (ok && placed) {
+    ht_frozen_entry_t *entries =
+        (ht_frozen_entry_t *)((char *)frozen->data + entries_offset);
+    char *keys = (char *)frozen->data + keys_offset;
+    uint64_t key = 0;
+    for (int i = 0; i < count; ++i) {
+      ht_frozen_entry_t *entry = &entries[positions[i]];
+      entry->key = key;
+      entry->length = items[i]->length;
+      entry->value = items[i]->value;
+      memcpy(keys + key, items[i]->key, items[i]->length + 1);
+      key += items[i]->length + 1;
+    }
+
+    frozen->pilots = pilots;
+    frozen->entries = entries;
+    frozen->keys = keys;
+    frozen->count = count;
+    frozen->buckets = buckets;
+  } else {
+    ht_frozen_dispose(frozen);
+  }
+
+  free(items);
+  free(hashes);
+  free(order);
+  free(positions);
+  return ok && placed;
+}
+
+// Gets the value of the key, NULL if the key is not in the frozen table
+const float *ht_frozen_get(const ht_frozen_t *frozen, const char *key) {
+  if (!frozen->count) {
+    return NULL;
+  }
+
+  size_t length = strlen(key);
+  uint64_t hash = ht_hash_wy(key, length, frozen->seed);
+  uint32_t pilot = frozen->pilots[ht_frozen_bucket(hash, frozen->buckets)];
+  const ht_frozen_entry_t *entry =
+      &frozen->entries[ht_frozen_pos(hash, pilot, frozen->count)];
+  if (entry->length == length &&
+      memcmp(key, frozen->keys + entry->key, length) == 0) {
+    return &entry->value;
+  }
+  return NULL;
+}
+
+// Frees the memory of the frozen table
+void ht_frozen_dispose(ht_frozen_t *frozen) {
+  free(frozen->data);
+  memset(frozen, 0, sizeof(*frozen));
+}
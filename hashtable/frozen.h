@@ -0,0 +1,42 @@
+/*
+ * Neměnná tabulka s minimální perfektní rozptylovací funkcí, vytvořená z
+ * hotové tabulky s rozptýlenými položkami.
+ */
+
+#ifndef IAL_HASHTABLE_FROZEN_H
+#define IAL_HASHTABLE_FROZEN_H
+
+#include "hashtable.h"
+
+// Prvok zmrazenej tabuľky
+typedef struct ht_frozen_entry {
+  uint64_t key;    // pozícia kľúča v úseku kľúčov
+  uint32_t length; // dĺžka kľúča
+  float value;     // hodnota prvku
+} ht_frozen_entry_t;
+
+/*
+ * Tabuľka vytvorená funkciou ht_freeze, ktorá sa už nedá meniť. Kľúče sú
+ * rozdelené do košov podľa hashu a každý kôš má posunutie (pilot), s ktorým
+ * hash určí pozíciu kľúča v entries tak, že žiadne dva kľúče nemajú rovnakú
+ * pozíciu a žiadna pozícia nie je voľná. Vyhľadanie tak počíta jeden hash
+ * a porovná jeden kľúč.
+ *
+ * Posunutia, prvky aj kľúče sú v jednom bloku pamäte data.
+ */
+typedef struct ht_frozen {
+  void *data;                       // blok s posunutiami, prvkami a kľúčmi
+  size_t data_size;                 // veľkosť bloku data
+  const uint32_t *pilots;           // posunutie pre každý kôš
+  const ht_frozen_entry_t *entries; // prvky na pozíciách podľa hashu
+  const char *keys;                 // úsek kľúčov ukončených nulou
+  int count;                        // počet prvkov
+  int buckets;                      // počet košov
+  uint64_t seed;                    // seed pre ht_hash_wy
+} ht_frozen_t;
+
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen);
+const float *ht_frozen_get(const ht_frozen_t *frozen, const char *key);
+void ht_frozen_dispose(ht_frozen_t *frozen);
+
+#endif
@@ -0,0 +1,394 @@
+/*
+ * Rozptylovací funkce pro tabulku s rozptýlenými položkami.
+ */
+
+#include "hash.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// The SIMD versions are compiled with target attributes and chosen at
+// runtime, so they don't need any compiler flags
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HT_X86
+#include <immintrin.h>
+#endif
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+#define WY_P0 0xa0761d6478bd642full
+#define WY_P1 0xe7037ed1a0b428dbull
+#define WY_P2 0x8ebc6af09c88c6e3ull
+
+// Number of bytes processed by one step of ht_hash_vec
+#define VEC_STRIPE 32
+
+// Value added to the secret of each lane after each stripe, so that the
+// order of the stripes matters
+#define VEC_STEP 0x9e3779b97f4a7c15ull
+
+const ht_hash_info_t HT_HASHES[] = {
+    {"additive", ht_hash_additive, false},
+    {"fnv1a", ht_hash_fnv1a, false},
+    {"wy", ht_hash_wy, false},
+    {"wy-seeded", ht_hash_wy, true},
+    {"vec", ht_hash_vec, false},
+};
+
+const int HT_HASH_COUNT = sizeof(HT_HASHES) / sizeof(*HT_HASHES);
+
+uint64_t ht_hash_additive(const char *key, size_t length, uint64_t seed) {
+  // same as get_hash, just without the modulo
+  (void)seed;
+  int result = 1;
+  for (size_t i = 0; i < length; ++i) {
+    result += key[i];
+  }
+  return result;
+}
+
+uint64_t ht_hash_fnv1a(const char *key, size_t length, uint64_t seed) {
+  uint64_t result = FNV_OFFSET ^ seed;
+  for (size_t i = 0; i < length; ++i) {
+    result ^= (unsigned char)key[i];
+    result *= FNV_PRIME;
+  }
+  return result;
+}
+
+// Multiplies the numbers to 128 bits and stores the low half to `a` and the
+// high half to `b`
+static void wy_mum(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 u128;
+  u128 r = (u128)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = *a >> 32, la = (uint32_t)*a;
+  uint64_t hb = *b >> 32, lb = (uint32_t)*b;
+  uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+  uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+  *a = (mid << 32) | (uint32_t)ll;
+  *b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+#endif
+}
+
+// Multiplies the numbers to 128 bits and folds the result to 64 bits
+static uint64_t wy_mix(uint64_t a, uint64_t b) {
+  wy_mum(&a, &b);
+  return a ^ b;
+}
+
+static uint64_t wy_r8(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint64_t wy_r4(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Reads 1 to 3 bytes
+static uint64_t wy_r3(const unsigned char *p, size_t length) {
+  return ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) |
+         p[length - 1];
+}
+
+uint64_t ht_hash_wy(const char *key, size_t length, uint64_t seed) {
+  const unsigned char *p = (const unsigned char *)key;
+  uint64_t a = 0;
+  uint64_t b = 0;
+
+  seed ^= wy_mix(seed ^ WY_P0, WY_P1);
+
+  if (length <= 16) {
+    if (length >= 4) {
+      // two possibly overlapping reads from each end cover all the bytes
+      size_t off = (length >> 3) << 2;
+      a = (wy_r4(p) << 32) | wy_r4(p + off);
+      b = (wy_r4(p + length - 4) << 32) | wy_r4(p + length - 4 - off);
+    } else if (length > 0) {
+      a = wy_r3(p, length);
+    }
+  } else {
+    size_t i = length;
+    for (; i > 16; i -= 16, p += 16) {
+      seed = wy_mix(wy_r8(p) ^ WY_P1, wy_r8(p + 8) ^ seed);
+    }
+    // the last 16 bytes, may overlap with the already processed ones
+    a = wy_r8(p + i - 16);
+    b = wy_r8(p + i - 8);
+  }
+
+  a ^= WY_P1;
+  b ^= seed;
+  wy_mum(&a, &b);
+  return wy_mix(a ^ WY_P0 ^ length, b ^ WY_P2);
+}
+
+// Secrets of the four 8-byte lanes of the first stripe
+static const uint64_t VEC_SECRET[4] = {
+    WY_P0,
+    WY_P1,
+    WY_P2,
+    0x589965cc75374cc3ull,
+};
+
+// Detects the best instruction set supported by the CPU
+static ht_simd_t simd_detect(void) {
+#ifdef HT_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return HT_SIMD_AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return HT_SIMD_SSE2;
+  }
+#endif
+  return HT_SIMD_SCALAR;
+}
+
+// The detection runs once, -1 until then. Threads that race on the first
+// call store the same value.
+static atomic_int simd_best = -1;
+
+ht_simd_t ht_simd_best(void) {
+  int best = atomic_load_explicit(&simd_best, memory_order_relaxed);
+  if (best < 0) {
+    best = simd_detect();
+    atomic_store_explicit(&simd_best, best, memory_order_relaxed);
+  }
+  return best;
+}
+
+// Gets offset of the next stripe of key with the given length, the last
+// stripe may overlap with the previous one. Returns false after the last
+// stripe.
+static bool vec_next(size_t *offset, size_t length) {
+  if (*offset + VEC_STRIPE == length) {
+    return false;
+  }
+  *offset += VEC_STRIPE;
+  if (*offset + VEC_STRIPE > length) {
+    *offset = length - VEC_STRIPE;
+  }
+  return true;
+}
+
+// Stores the accumulators of all the stripes of the key to `acc`. Each lane
+// adds the product of the halves of its data mixed with the secret, and the
+// data itself to the neighbouring lane, so that no bits are lost when the
+// product is 0.
+static void vec_accumulate_scalar(uint64_t acc[4], const unsigned char *p,
+                                  size_t length, uint64_t seed) {
+  uint64_t secret[4];
+  for (int j = 0; j < 4; ++j) {
+    secret[j] = VEC_SECRET[j] ^ seed;
+  }
+  acc[0] = seed;
+  acc[1] = WY_P0;
+  acc[2] = seed ^ WY_P1;
+  acc[3] = WY_P2;
+  size_t offset = 0;
+  do {
+    for (int j = 0; j < 4; ++j) {
+      uint64_t data = wy_r8(p + offset + 8 * j);
+      uint64_t mixed = data ^ secret[j];
+      acc[j ^ 1] += data;
+      acc[j] += (mixed & 0xffffffff) * (mixed >> 32);
+      secret[j] += VEC_STEP;
+    }
+  } while (vec_next(&offset, length));
+}
+
+#ifdef HT_X86
+
+// Same as the scalar step of ht_hash_vec for two lanes
+__attribute__((target("sse2"))) static inline __m128i
+vec_lanes_sse2(__m128i acc, __m128i data, __m128i secret) {
+  __m128i mixed = _mm_xor_si128(data, secret);
+  // swapping the 64-bit halves adds the data to the neighbouring lane
+  acc = _mm_add_epi64(acc, _mm_shuffle_epi32(data, 0x4e));
+  return _mm_add_epi64(acc, _mm_mul_epu32(mixed, _mm_srli_epi64(mixed, 32)));
+}
+
+// The initial values are created in registers, loading them from memory
+// written by scalar stores would stall
+__attribute__((target("sse2"))) static void
+vec_accumulate_sse2(uint64_t acc[4], const unsigned char *p, size_t length,
+                    uint64_t seed) {
+  __m128i acc0 = _mm_set_epi64x(WY_P0, seed);
+  __m128i acc1 = _mm_set_epi64x(WY_P2, seed ^ WY_P1);
+  __m128i secret0 = _mm_set_epi64x(VEC_SECRET[1] ^ seed, VEC_SECRET[0] ^ seed);
+  __m128i secret1 = _mm_set_epi64x(VEC_SECRET[3] ^ seed, VEC_SECRET[2] ^ seed);
+  const __m128i step = _mm_set1_epi64x(VEC_STEP);
+  size_t offset = 0;
+  do {
+    const __m128i *data = (const __m128i *)(p + offset);
+    acc0 = vec_lanes_sse2(acc0, _mm_loadu_si128(data), secret0);
+    acc1 = vec_lanes_sse2(acc1, _mm_loadu_si128(data + 1), secret1);
+    secret0 = _mm_add_epi64(secret0, step);
+    secret1 = _mm_add_epi64(secret1, step);
+  } while (vec_next(&offset, length));
+  _mm_storeu_si128((__m128i *)acc, acc0);
+  _mm_storeu_si128((__m128i *)(acc + 2), acc1);
+}
+
+__attribute__((target("avx2"))) static void
+vec_accumulate_avx2(uint64_t acc[4], const unsigned char *p, size_t length,
+                    uint64_t seed) {
+  __m256i lanes = _mm256_set_epi64x(WY_P2, seed ^ WY_P1, WY_P0, seed);
+  __m256i key = _mm256_xor_si256(
+      _mm256_set_epi64x(VEC_SECRET[3], VEC_SECRET[2], VEC_SECRET[1],
+                        VEC_SECRET[0]),
+      _mm256_set1_epi64x(seed));
+  const __m256i step = _mm256_set1_epi64x(VEC_STEP);
+  size_t offset = 0;
+  do {
+    __m256i data = _mm256_loadu_si256((const __m256i *)(p + offset));
+    __m256i mixed = _mm256_xor_si256(data, key);
+    lanes = _mm256_add_epi64(lanes, _mm256_shuffle_epi32(data, 0x4e));
+    lanes = _mm256_add_epi64(
+        lanes, _mm256_mul_epu32(mixed, _mm256_srli_epi64(mixed, 32)));
+    key = _mm256_add_epi64(key, step);
+  } while (vec_next(&offset, length));
+  _mm256_storeu_si256((__m256i *)acc, lanes);
+}
+
+#endif // HT_X86
+
+uint64_t ht_hash_vec_simd(const char *key, size_t length, uint64_t seed,
+                          ht_simd_t simd) {
+  if (length < VEC_STRIPE) {
+    return ht_hash_wy(key, length, seed);
+  }
+
+  const unsigned char *p = (const unsigned char *)key;
+  uint64_t acc[4];
+
+  ht_simd_t best = ht_simd_best();
+  switch (simd > best ? best : simd) {
+#ifdef HT_X86
+  case HT_SIMD_AVX2:
+    vec_accumulate_avx2(acc, p, length, seed);
+    break;
+  case HT_SIMD_SSE2:
+    vec_accumulate_sse2(acc, p, length, seed);
+    break;
+#endif
+  default:
+    vec_accumulate_scalar(acc, p, length, seed);
+    break;
+  }
+
+  uint64_t a = wy_mix(acc[0] ^ WY_P0, acc[1] ^ WY_P1);
+  uint64_t b = wy_mix(acc[2] ^ WY_P2, acc[3] ^ seed);
+  return wy_mix(a ^ length, b ^ WY_P0);
+}
+
+uint64_t ht_hash_vec(const char *key, size_t length, uint64_t seed) {
+  return ht_hash_vec_simd(key, length, seed, HT_SIMD_AVX2);
+}
+
+static bool key_equal_scalar(const unsigned char *a, const unsigned char *b,
+                             size_t length) {
+  if (length >= 8) {
+    for (size_t i = 0; i + 8 < length; i += 8) {
+      if (wy_r8(a + i) != wy_r8(b + i)) {
+        return false;
+      }
+    }
+    // the last 8 bytes, may overlap with the already compared ones
+    return wy_r8(a + length - 8) == wy_r8(b + length - 8);
+  }
+  if (length >= 4) {
+    return wy_r4(a) == wy_r4(b) &&
+           wy_r4(a + length - 4) == wy_r4(b + length - 4);
+  }
+  for (size_t i = 0; i < length; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#ifdef HT_X86
+
+__attribute__((target("sse2"))) static inline bool
+key_equal16_sse2(const unsigned char *a, const unsigned char *b) {
+  __m128i x = _mm_loadu_si128((const __m128i *)a);
+  __m128i y = _mm_loadu_si128((const __m128i *)b);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xffff;
+}
+
+__attribute__((target("sse2"))) static bool
+key_equal_sse2(const unsigned char *a, const unsigned char *b,
+               size_t length) {
+  if (length < 16) {
+    return key_equal_scalar(a, b, length);
+  }
+  for (size_t i = 0; i + 16 < length; i += 16) {
+    if (!key_equal16_sse2(a + i, b + i)) {
+      return false;
+    }
+  }
+  return key_equal16_sse2(a + length - 16, b + length - 16);
+}
+
+__attribute__((target("avx2"))) static inline bool
+key_equal32_avx2(const unsigned char *a, const unsigned char *b) {
+  __m256i x = _mm256_loadu_si256((const __m256i *)a);
+  __m256i y = _mm256_loadu_si256((const __m256i *)b);
+  return _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)) == -1;
+}
+
+__attribute__((target("avx2"))) static bool
+key_equal_avx2(const unsigned char *a, const unsigned char *b,
+               size_t length) {
+  if (length < 32) {
+    return key_equal_sse2(a, b, length);
+  }
+  for (size_t i = 0; i + 32 < length; i += 32) {
+    if (!key_equal32_avx2(a + i, b + i)) {
+      return false;
+    }
+  }
+  return key_equal32_avx2(a + length - 32, b + length - 32);
+}
+
+#endif // HT_X86
+
+bool ht_key_equal_simd(const char *a, const char *b, size_t length,
+                       ht_simd_t simd) {
+  const unsigned char *x = (const unsigned char *)a;
+  const unsigned char *y = (const unsigned char *)b;
+  ht_simd_t best = ht_simd_best();
+  switch (simd > best ? best : simd) {
+#ifdef HT_X86
+  case HT_SIMD_AVX2:
+    return key_equal_avx2(x, y, length);
+  case HT_SIMD_SSE2:
+    return key_equal_sse2(x, y, length);
+#endif
+  default:
+    return key_equal_scalar(x, y, length);
+  }
+}
+
+bool ht_key_equal(const char *a, const char *b, size_t length) {
+  return ht_key_equal_simd(a, b, length, HT_SIMD_AVX2);
+}
+
+uint64_t ht_random_seed(void) {
+  // there is no portable source of randomness in C11, so mix whatever
+  // differs between runs (time, clock and address of a local variable)
+  int local;
+  uint64_t seed = (uint64_t)time(NULL);
+  seed = wy_mix(seed ^ WY_P0, (uint64_t)clock() ^ WY_P1);
+  return wy_mix(seed ^ (uint64_t)(uintptr_t)&local, WY_P2);
+}
@@ -0,0 +1,69 @@
+/*
+ * Rozptylovací funkce pro tabulku s rozptýlenými položkami.
+ */
+
+#ifndef IAL_HASHTABLE_HASH_H
+#define IAL_HASHTABLE_HASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hash function used by the table. `length` is the length of `key` without
+// the terminating null and `seed` is the seed stored in the table.
+typedef uint64_t (*ht_hash_fn_t)(const char *key, size_t length,
+                                 uint64_t seed);
+
+// The original additive hash (sum of the character codes). Kept only for
+// comparison, anagrams always collide.
+uint64_t ht_hash_additive(const char *key, size_t length, uint64_t seed);
+// 64-bit FNV-1a, the seed is mixed into the offset basis.
+uint64_t ht_hash_fnv1a(const char *key, size_t length, uint64_t seed);
+// wyhash style hash, reads 8 bytes at a time and mixes them with 64x64->128
+// bit multiplication.
+uint64_t ht_hash_wy(const char *key, size_t length, uint64_t seed);
+
+// Hash that processes keys of at least 32 bytes in stripes of 32 bytes with
+// SSE2 or AVX2 if the CPU has it. All the instruction sets give the same
+// result. Shorter keys are hashed with ht_hash_wy. ht_hash_wy already reads
+// 16 bytes per step, so this is faster only for keys of hundreds of bytes.
+uint64_t ht_hash_vec(const char *key, size_t length, uint64_t seed);
+
+// Instruction sets used by ht_hash_vec and ht_key_equal
+typedef enum ht_simd {
+  HT_SIMD_SCALAR,
+  HT_SIMD_SSE2,
+  HT_SIMD_AVX2,
+} ht_simd_t;
+
+// Gets the best instruction set supported by the CPU
+ht_simd_t ht_simd_best(void);
+// Same as ht_hash_vec, but with the given instruction set. Instruction set
+// that the CPU doesn't support is replaced by the best supported one.
+uint64_t ht_hash_vec_simd(const char *key, size_t length, uint64_t seed,
+                          ht_simd_t simd);
+
+// Checks whether the keys have the same first `length` bytes. Reads only
+// the `length` bytes of each key, so it is safe at the end of memory. The
+// tables keep using memcmp, which is vectorized in glibc too and faster for
+// short keys (see ./bench).
+bool ht_key_equal(const char *a, const char *b, size_t length);
+// Same as ht_key_equal, but with the given instruction set
+bool ht_key_equal_simd(const char *a, const char *b, size_t length,
+                       ht_simd_t simd);
+
+// Creates seed that is different in each process, use it with ht_hash_wy to
+// make the table resistant to hash flooding.
+uint64_t ht_random_seed(void);
+
+// Named hash function, used by the reports to iterate all the options
+typedef struct ht_hash_info {
+  const char *name;  // name of the hash
+  ht_hash_fn_t hash; // the hash function
+  bool seeded;       // true if the hash should be used with random seed
+} ht_hash_info_t;
+
+extern const ht_hash_info_t HT_HASHES[];
+extern const int HT_HASH_COUNT;
+
+#endif
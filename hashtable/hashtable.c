@@ -14,6 +14,22 @@
 
 int HT_SIZE = MAX_HT_SIZE;
 
+// Deleted keys are removed from the arena only if they take more than this
+#define ARENA_MIN_GARBAGE 4096
+
+// Number of keys processed together by the batch functions
+#define BATCH_GROUP 16
+
+// How many buckets ahead ht_for_each loads the chains
+#define ITER_PREFETCH 8
+
+// Hint to the CPU to start loading the memory
+#ifdef __GNUC__
+#define PREFETCH(ADDR) __builtin_prefetch(ADDR)
+#else
+#define PREFETCH(ADDR) ((void)(ADDR))
+#endif
+
 /*
  * Rozptylovací funkce která přidělí zadanému klíči index z intervalu
  * <0,HT_SIZE-1>. Ideální rozptylovací funkce by měla rozprostírat klíče
@@ -32,22 +48,278 @@ int get_hash(char *key) {
  * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
  */
 void ht_init(ht_table_t *table) {
-  // cast to more reasonable type
-  ht_item_t **tab = (ht_item_t **)table;
+  ht_init_hash(table, ht_hash_wy, 0);
+}
+
+// Initializes the table to use the given hash function. Use ht_hash_additive
+// to get the same distribution as get_hash.
+void ht_init_hash(ht_table_t *table, ht_hash_fn_t hash, uint64_t seed) {
+  table->items = calloc(HT_SIZE, sizeof(*table->items));
+  table->size = table->items ? HT_SIZE : 0;
+  table->min_size = HT_SIZE;
+  table->count = 0;
+  table->old_items = NULL;
+  table->old_size = 0;
+  table->migrated = 0;
+  table->rehash_budget = 0;
+  table->max_load = HT_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+  table->hash = hash;
+  table->seed = seed;
+  table->own_keys = false;
+  table->value_size = 0;
+  table->reorder = HT_REORDER_NONE;
+  ht_filter_init(&table->filter);
+  ht_slab_init(&table->slab, sizeof(ht_item_t), 0);
+  ht_arena_init(&table->keys);
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+}
+
+// Gets size of the space for value stored after the item, rounded so that
+// the short key after it doesn't break alignment of the next item
+static size_t ht_value_space(size_t value_size) {
+  return (value_size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+}
+
+// Gets size of the item allocation. Values set by ht_insert_value are stored
+// right after the item and owned short keys after them, so that the fields
+// read when walking the chains stay together at the start of the item.
+static size_t ht_item_size(size_t value_size, bool own_keys) {
+  return sizeof(ht_item_t) + ht_value_space(value_size) +
+         (own_keys ? HT_SHORT_KEY : 0);
+}
+
+// Gets the place for owned short key of the item
+static char *ht_short_key(ht_table_t *table, ht_item_t *item) {
+  return (char *)(item + 1) + ht_value_space(table->value_size);
+}
+
+// Makes the table allocate its items from blocks of `block_count` items, 0
+// switches back to malloc for each item. Works only on empty table.
+bool ht_use_slab(ht_table_t *table, int block_count) {
+  if (table->count) {
+    return false;
+  }
+
+  ht_slab_release(&table->slab);
+  ht_slab_init(&table->slab, ht_item_size(table->value_size, table->own_keys),
+               block_count);
+  return true;
+}
+
+// Makes the table copy the inserted keys, so that the caller doesn't have to
+// keep them alive. Works only on empty table.
+bool ht_own_keys(ht_table_t *table, bool own) {
+  if (table->count) {
+    return false;
+  }
+
+  ht_slab_release(&table->slab);
+  ht_slab_init(&table->slab, ht_item_size(table->value_size, own),
+               table->slab.block_count);
+  table->own_keys = own;
+  return true;
+}
+
+// Makes the table store values with `value_size` bytes, which are set with
+// ht_insert_value and read with ht_get_value. The values are stored in the
+// item, aligned at least as pointers. 0 switches back to float values. Works
+// only on empty table.
+bool ht_use_values(ht_table_t *table, size_t value_size) {
+  if (table->count) {
+    return false;
+  }
+
+  ht_slab_release(&table->slab);
+  ht_slab_init(&table->slab, ht_item_size(value_size, table->own_keys),
+               table->slab.block_count);
+  table->value_size = value_size;
+  return true;
+}
+
+// Creates new filter with the given capacity from all the items in the
+// table. The old filter is kept if the new one can't be created.
+static bool ht_build_filter(ht_table_t *table, int capacity, float fp_rate) {
+  ht_filter_t filter;
+  if (!ht_filter_create(&filter, capacity, fp_rate)) {
+    return false;
+  }
+
+  ht_iter_t iter;
+  ht_iter_begin(table, &iter);
+  for (ht_item_t *item; (item = ht_iter_next(&iter));) {
+    ht_filter_add(&filter, item->hash);
+  }
+  ht_filter_release(&table->filter);
+  table->filter = filter;
+  return true;
+}
 
-  for (int i = 0; i < HT_SIZE; ++i) {
-    tab[i] = NULL;
+// Makes the table keep filter of its keys with about `fp_rate` false
+// positives, so that most lookups of missing keys don't read the chains. 0
+// removes the filter. The filter grows with the table.
+bool ht_use_filter(ht_table_t *table, float fp_rate) {
+  if (!fp_rate) {
+    ht_filter_release(&table->filter);
+    return true;
+  }
+  int capacity = table->size * table->max_load;
+  if (capacity < table->count * 2) {
+    capacity = table->count * 2;
+  }
+  return ht_build_filter(table, capacity, fp_rate);
+}
+
+// Gets pointer to the value of item in table with values set by
+// ht_use_values
+void *ht_item_value(ht_item_t *item) {
+  return item + 1;
+}
+
+// Checks whether the key of item is stored in the table arena
+static bool ht_key_in_arena(ht_table_t *table, ht_item_t *item) {
+  return table->own_keys && item->key != ht_short_key(table, item);
+}
+
+// Copies the keys in the chains to the arena
+static void ht_copy_keys(ht_table_t *table, ht_item_t **items, int size,
+                         ht_arena_t *keys) {
+  for (int i = 0; i < size; ++i) {
+    for (ht_item_t *item = items[i]; item; item = item->next) {
+      if (ht_key_in_arena(table, item)) {
+        item->key = ht_arena_strdup(keys, item->key, item->length);
+      }
+    }
+  }
+}
+
+// Moves the keys that are still used to new arena and frees the old one
+static void ht_compact_keys(ht_table_t *table) {
+  ht_arena_t keys;
+  ht_arena_init(&keys);
+
+  // with everything in one chunk, the copying can't fail
+  size_t live = table->keys.used - table->keys.garbage;
+  if (live && !ht_arena_reserve(&keys, live)) {
+    return;
+  }
+
+  ht_copy_keys(table, table->items, table->size, &keys);
+  if (table->old_items) {
+    ht_copy_keys(table, table->old_items + table->migrated,
+                 table->old_size - table->migrated, &keys);
+  }
+
+  ht_arena_release(&table->keys);
+  keys.mallocs += table->keys.mallocs;
+  keys.frees += table->keys.frees;
+  table->keys = keys;
+}
+
+// Gets the smallest prime that is not smaller than `n`
+static int ht_next_prime(int n) {
+  if (n <= 2) {
+    return 2;
+  }
+  for (n |= 1;; n += 2) {
+    int d = 3;
+    for (; d * d <= n && n % d; d += 2)
+      ;
+    if (d * d > n) {
+      return n;
+    }
+  }
+}
+
+// Moves up to `budget` buckets from the old array to the new one. Frees the
+// old array when all of its buckets are moved.
+static void ht_migrate(ht_table_t *table, int budget) {
+  for (; table->old_items && budget > 0; --budget) {
+    ht_item_t *item = table->old_items[table->migrated];
+    while (item) {
+      ht_item_t *next = item->next;
+      // the order of synonyms doesn't matter, so insert to the start
+      ht_item_t **bucket = &table->items[item->hash % table->size];
+      item->next = *bucket;
+      *bucket = item;
+      item = next;
+    }
+
+    if (++table->migrated == table->old_size) {
+      free(table->old_items);
+      table->old_items = NULL;
+      table->old_size = 0;
+    }
   }
 }
 
-// Gets pointer to position of item with the key
-ht_item_t **ht_find(ht_table_t *table, char *key) {
-  // cast to more reasonable type
-  ht_item_t **tab = (ht_item_t **)table;
-  ht_item_t **item = &tab[get_hash(key)];
+// Moves all the items to new array of buckets with the given size. If the
+// allocation fails, the table is left unchanged and false is returned.
+//
+// If rehash_budget is not 0, the items are moved incrementally by the
+// following operations on the table.
+bool ht_resize(ht_table_t *table, int size) {
+  // there can be only one migration at a time
+  ht_migrate(table, table->old_size);
+
+  ht_item_t **items = calloc(size, sizeof(*items));
+  if (!items) {
+    return false;
+  }
+
+  table->old_items = table->items;
+  table->old_size = table->size;
+  table->migrated = 0;
+  table->items = items;
+  table->size = size;
+  HT_COUNT(table, rehashes, 1);
+
+  if (!table->rehash_budget) {
+    ht_migrate(table, table->old_size);
+  }
+  return true;
+}
+
+// Checks whether the item has the key with the given length and hash.
+// Comparing the hash and length first avoids reading the keys of most
+// synonyms.
+static bool ht_item_is(ht_item_t *item, const char *key, size_t length,
+                       uint64_t hash) {
+  return item->hash == hash && item->length == length &&
+         memcmp(key, item->key, length) == 0;
+}
+
+// Gets pointer to position of item with the key, NULL if the table has no
+// buckets. If the key is not in the table, the position is at the end of
+// chain in the new bucket array.
+ht_item_t **ht_find(ht_table_t *table, const char *key, size_t length,
+                    uint64_t hash) {
+  if (!table->size) {
+    return NULL;
+  }
+
+  ht_migrate(table, table->rehash_budget);
+
+  ht_item_t **item;
+
+  // buckets that were not migrated yet are still in the old array
+  if (table->old_items && hash % table->old_size >= table->migrated) {
+    item = &table->old_items[hash % table->old_size];
+    for (; *item; item = &(*item)->next) {
+      HT_COUNT(table, visited, 1);
+      if (ht_item_is(*item, key, length, hash)) {
+        return item;
+      }
+    }
+  }
+
+  item = &table->items[hash % table->size];
 
   for (; *item; item = &(*item)->next) {
-    if (strcmp(key, (*item)->key) == 0) {
+    HT_COUNT(table, visited, 1);
+    if (ht_item_is(*item, key, length, hash)) {
       return item;
     }
   }
@@ -55,6 +327,12 @@ ht_item_t **ht_find(ht_table_t *table, char *key) {
   return item;
 }
 
+// Gets the hash of key as used by the table, so that it can be passed to the
+// *_hashed functions
+uint64_t ht_key_hash(ht_table_t *table, const char *key, size_t length) {
+  return table->hash(key, length, table->seed);
+}
+
 /*
  * Vyhledání prvku v tabulce.
  *
@@ -62,7 +340,72 @@ ht_item_t **ht_find(ht_table_t *table, char *key) {
  * hodnotu NULL.
  */
 ht_item_t *ht_search(ht_table_t *table, char *key) {
-  return *ht_find(table, key);
+  size_t length = strlen(key);
+  return ht_search_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Gets the start of the chain that contains the position `pos` of key with
+// the hash
+static ht_item_t **ht_chain_head(ht_table_t *table, uint64_t hash,
+                                 ht_item_t **pos) {
+  if (table->old_items && hash % table->old_size >= table->migrated) {
+    ht_item_t **head = &table->old_items[hash % table->old_size];
+    for (ht_item_t **i = head; *i; i = &(*i)->next) {
+      if (i == pos) {
+        return head;
+      }
+    }
+  }
+  return &table->items[hash % table->size];
+}
+
+// Moves the found item at `pos` closer to the start of its chain, so that
+// frequently searched keys are found sooner
+static void ht_reorder(ht_table_t *table, uint64_t hash, ht_item_t **pos) {
+  ht_item_t **head = ht_chain_head(table, hash, pos);
+  if (pos == head) {
+    return;
+  }
+
+  ht_item_t *item = *pos;
+  if (table->reorder == HT_REORDER_FRONT) {
+    *pos = item->next;
+    item->next = *head;
+    *head = item;
+    return;
+  }
+
+  // find the position of the previous item, the chain was just walked so it
+  // is in cache
+  ht_item_t **prev = head;
+  while (&(*prev)->next != pos) {
+    prev = &(*prev)->next;
+  }
+  *pos = item->next;
+  item->next = *prev;
+  *prev = item;
+}
+
+// Same as ht_search, but with already known length and hash of the key
+ht_item_t *ht_search_hashed(ht_table_t *table, const char *key, size_t length,
+                            uint64_t hash) {
+  // the migration waits for the next operation that reads the chains
+  if (!ht_filter_may_contain(&table->filter, hash)) {
+    HT_COUNT(table, lookups, 1);
+    HT_COUNT(table, misses, 1);
+    HT_COUNT(table, filtered, 1);
+    return NULL;
+  }
+
+  ht_item_t **i = ht_find(table, key, length, hash);
+  ht_item_t *item = i ? *i : NULL;
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, item != NULL);
+  HT_COUNT(table, misses, item == NULL);
+  if (item && table->reorder) {
+    ht_reorder(table, hash, i);
+  }
+  return item;
 }
 
 /*
@@ -74,29 +417,93 @@ ht_item_t *ht_search(ht_table_t *table, char *key) {
  * synonym zvolte nejefektivnější možnost a vložte prvek na začátek seznamu.
  */
 void ht_insert(ht_table_t *table, char *key, float value) {
+  size_t length = strlen(key);
+  ht_insert_hashed(table, key, length, ht_key_hash(table, key, length),
+                   value);
+}
+
+// Gets the item with the key, new item is added if there is none. The value
+// of new item is 0. Returns NULL on failure.
+static ht_item_t *ht_insert_item(ht_table_t *table, const char *key,
+                                 size_t length, uint64_t hash) {
   // I used ht_find instead of ht_search, because this way I need only one
   // lookup in the table.
-  ht_item_t **i = ht_find(table, key);
+  ht_item_t **i = ht_find(table, key, length, hash);
+  if (!i) {
+    return NULL;
+  }
 
   ht_item_t *item = *i;
 
   if (item) {
-    // modify existing
-    item->value = value;
-    return;
+    // the caller modifies the existing item
+    return item;
   }
 
   // create new item
-  item = malloc(sizeof(*item));
+  item = ht_slab_alloc(&table->slab);
   if (!item) {
-    return;
+    return NULL;
   }
 
-  item->key = key;
-  item->value = value;
+  char *item_key = (char *)key;
+  if (table->own_keys) {
+    item_key = length < HT_SHORT_KEY
+                   ? ht_short_key(table, item)
+                   : ht_arena_strdup(&table->keys, key, length);
+    if (!item_key) {
+      ht_slab_free(&table->slab, item);
+      return NULL;
+    }
+    if (length < HT_SHORT_KEY) {
+      memcpy(item_key, key, length);
+      item_key[length] = 0;
+    }
+  }
+
+  item->key = item_key;
+  item->value = 0;
+  item->length = length;
   item->next = NULL;
+  item->hash = hash;
 
   *i = item;
+  ++table->count;
+  HT_COUNT(table, inserts, 1);
+
+  // the filter is rebuilt larger before its false positives get too common
+  ht_filter_add(&table->filter, hash);
+  if (table->filter.counters && table->count > table->filter.capacity) {
+    ht_build_filter(table, table->count * 2, table->filter.fp_rate);
+  }
+
+  // grow to keep the chains short, if it fails the table will just be slower
+  if (table->max_load && !table->old_items &&
+      table->count > table->size * table->max_load) {
+    ht_resize(table, ht_next_prime(table->size * 2));
+  }
+  return item;
+}
+
+// Same as ht_insert, but with already known length and hash of the key. If
+// the table doesn't own the keys, the key must be null-terminated.
+void ht_insert_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash, float value) {
+  ht_item_t *item = ht_insert_item(table, key, length, hash);
+  if (item) {
+    item->value = value;
+  }
+}
+
+// Inserts the key with value of the size set by ht_use_values, the value is
+// copied to the table
+void ht_insert_value(ht_table_t *table, char *key, const void *value) {
+  size_t length = strlen(key);
+  ht_item_t *item =
+      ht_insert_item(table, key, length, ht_key_hash(table, key, length));
+  if (item) {
+    memcpy(ht_item_value(item), value, table->value_size);
+  }
 }
 
 /*
@@ -112,6 +519,20 @@ float *ht_get(ht_table_t *table, char *key) {
   return i ? &i->value : NULL;
 }
 
+// Gets pointer to the value of the key in table with values set by
+// ht_use_values, NULL if the key is not in the table
+void *ht_get_value(ht_table_t *table, char *key) {
+  ht_item_t *i = ht_search(table, key);
+  return i ? ht_item_value(i) : NULL;
+}
+
+// Same as ht_get, but with already known length and hash of the key
+float *ht_get_hashed(ht_table_t *table, const char *key, size_t length,
+                     uint64_t hash) {
+  ht_item_t *i = ht_search_hashed(table, key, length, hash);
+  return i ? &i->value : NULL;
+}
+
 /*
  * Smazání prvku z tabulky.
  *
@@ -121,14 +542,323 @@ float *ht_get(ht_table_t *table, char *key) {
  * Při implementaci NEPOUŽÍVEJTE funkci ht_search.
  */
 void ht_delete(ht_table_t *table, char *key) {
+  size_t length = strlen(key);
+  ht_delete_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Removes the item at the position from its chain and frees it
+static void ht_unlink(ht_table_t *table, ht_item_t **pos) {
+  ht_item_t *item = *pos;
+  *pos = item->next;
+  ht_filter_remove(&table->filter, item->hash);
+  if (ht_key_in_arena(table, item)) {
+    ht_arena_forget(&table->keys, item->length);
+  }
+  ht_slab_free(&table->slab, item);
+  --table->count;
+  HT_COUNT(table, deletes, 1);
+}
+
+// Compacts the keys and shrinks the table if there are too many deleted
+// items
+static void ht_after_delete(ht_table_t *table) {
+  // don't let the deleted keys take most of the arena
+  if (table->keys.garbage > ARENA_MIN_GARBAGE &&
+      table->keys.garbage > table->keys.used / 2) {
+    ht_compact_keys(table);
+  }
+
+  // shrink so that the memory is released after mass delete
+  if (table->min_load && !table->old_items &&
+      table->size > table->min_size &&
+      table->count < table->size * table->min_load) {
+    int size = ht_next_prime(table->size / 2);
+    ht_resize(table, size < table->min_size ? table->min_size : size);
+  }
+}
+
+// Same as ht_delete, but with already known length and hash of the key
+void ht_delete_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash) {
+  if (!ht_filter_may_contain(&table->filter, hash)) {
+    return;
+  }
+
   // I cannot use ht_search, but it wouldn't make sense to use it, so I use
   // ht_find
-  ht_item_t **i = ht_find(table, key);
-  ht_item_t *item = *i;
+  ht_item_t **i = ht_find(table, key, length, hash);
+  if (!i || !*i) {
+    return;
+  }
 
-  if (item) {
-    *i = item->next;
-    free(item);
+  ht_unlink(table, i);
+  ht_after_delete(table);
+}
+
+// Looks up group of at most BATCH_GROUP keys. The memory of all the keys is
+// loaded in stages, so that the CPU waits for all of them at once instead of
+// for each one separately.
+static void ht_get_group(ht_table_t *table, char *keys[], int n,
+                         float *values[]) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+  ht_item_t **buckets[BATCH_GROUP];
+  ht_item_t *items[BATCH_GROUP];
+
+  // hash the keys and start loading the buckets of keys that pass the filter
+  for (int i = 0; i < n; ++i) {
+    lengths[i] = strlen(keys[i]);
+    hashes[i] = ht_key_hash(table, keys[i], lengths[i]);
+    buckets[i] = NULL;
+    if (ht_filter_may_contain(&table->filter, hashes[i])) {
+      buckets[i] = &table->items[hashes[i] % table->size];
+      PREFETCH(buckets[i]);
+    } else {
+      HT_COUNT(table, filtered, 1);
+    }
+  }
+
+  // start loading the first items in the chains
+  for (int i = 0; i < n; ++i) {
+    items[i] = buckets[i] ? *buckets[i] : NULL;
+    PREFETCH(items[i]);
+  }
+
+  // find items with matching hash and length and start loading their keys
+  for (int i = 0; i < n; ++i) {
+    ht_item_t *item = items[i];
+    while (item && (item->hash != hashes[i] || item->length != lengths[i])) {
+      HT_COUNT(table, visited, 1);
+      item = item->next;
+    }
+    items[i] = item;
+    if (item) {
+      PREFETCH(item->key);
+    }
+  }
+
+  // compare the keys, on the unlikely hash collision continue the search
+  for (int i = 0; i < n; ++i) {
+    ht_item_t *item = items[i];
+    while (item && !ht_item_is(item, keys[i], lengths[i], hashes[i])) {
+      HT_COUNT(table, visited, 1);
+      item = item->next;
+    }
+    HT_COUNT(table, visited, item != NULL);
+    HT_COUNT(table, hits, item != NULL);
+    HT_COUNT(table, misses, item == NULL);
+    items[i] = item;
+    values[i] = item ? &item->value : NULL;
+  }
+  HT_COUNT(table, lookups, n);
+
+  // reorder the chains as ht_get does, only after all the searches, so that
+  // the walks above don't see the chains change
+  for (int i = 0; table->reorder && i < n; ++i) {
+    if (items[i]) {
+      ht_item_t **pos = buckets[i];
+      while (*pos != items[i]) {
+        pos = &(*pos)->next;
+      }
+      ht_reorder(table, hashes[i], pos);
+    }
+  }
+}
+
+// Stores the result of ht_get for keys[i] to values[i]. The memory loads
+// for multiple keys overlap, so it is faster than calling ht_get in loop.
+void ht_get_batch(ht_table_t *table, char *keys[], int n, float *values[]) {
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    ht_migrate(table, table->rehash_budget);
+
+    // during migration some keys may be in the old array
+    if (!table->size || table->old_items) {
+      for (int j = i; j < i + group; ++j) {
+        values[j] = ht_get(table, keys[j]);
+      }
+      continue;
+    }
+
+    ht_get_group(table, keys + i, group, values + i);
+  }
+}
+
+// Same as calling ht_insert for all the pairs keys[i], values[i]
+void ht_insert_batch(ht_table_t *table, char *keys[], float values[], int n) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    // hash the keys and start loading the buckets
+    for (int j = 0; j < group; ++j) {
+      lengths[j] = strlen(keys[i + j]);
+      hashes[j] = ht_key_hash(table, keys[i + j], lengths[j]);
+      if (table->size) {
+        PREFETCH(&table->items[hashes[j] % table->size]);
+      }
+    }
+
+    for (int j = 0; j < group; ++j) {
+      ht_insert_hashed(table, keys[i + j], lengths[j], hashes[j],
+                       values[i + j]);
+    }
+  }
+}
+
+// Gets the bucket with the index, buckets of unfinished migration follow
+// after the current ones. NULL if there is no such bucket.
+static ht_item_t **ht_iter_bucket(ht_table_t *table, int bucket) {
+  if (bucket < table->size) {
+    return &table->items[bucket];
+  }
+  bucket += table->migrated - table->size;
+  return table->old_items && bucket < table->old_size
+             ? &table->old_items[bucket]
+             : NULL;
+}
+
+// Starts iteration over the items of the table
+void ht_iter_begin(ht_table_t *table, ht_iter_t *iter) {
+  iter->table = table;
+  iter->pos = NULL;
+  iter->bucket = 0;
+  iter->deleted = false;
+}
+
+// Gets the next item of the iteration, NULL if there are no more items
+ht_item_t *ht_iter_next(ht_iter_t *iter) {
+  if (iter->pos) {
+    // after delete the position already has the next item
+    if (!iter->deleted) {
+      iter->pos = &(*iter->pos)->next;
+    }
+    iter->deleted = false;
+    if (*iter->pos) {
+      return *iter->pos;
+    }
+    ++iter->bucket;
+  }
+
+  for (;; ++iter->bucket) {
+    ht_item_t **bucket = ht_iter_bucket(iter->table, iter->bucket);
+    if (!bucket) {
+      iter->pos = NULL;
+      return NULL;
+    }
+    if (*bucket) {
+      iter->pos = bucket;
+      return *bucket;
+    }
+  }
+}
+
+// Deletes the item last returned by ht_iter_next
+void ht_iter_delete(ht_iter_t *iter) {
+  if (iter->pos && !iter->deleted) {
+    ht_unlink(iter->table, iter->pos);
+    iter->deleted = true;
+  }
+}
+
+// Calls `visit` for the items in the chains, returns false if it stopped the
+// iteration. The items of the following chains are loaded in advance.
+static bool ht_visit_chains(ht_item_t **items, int size, ht_visit_fn_t visit,
+                            void *ctx) {
+  for (int i = 0; i < size; ++i) {
+    if (i + ITER_PREFETCH < size) {
+      PREFETCH(items[i + ITER_PREFETCH]);
+    }
+    for (ht_item_t *item = items[i]; item; item = item->next) {
+      if (!visit(item, ctx)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Calls `visit` for all the items until it returns false
+void ht_for_each(ht_table_t *table, ht_visit_fn_t visit, void *ctx) {
+  if (ht_visit_chains(table->items, table->size, visit, ctx) &&
+      table->old_items) {
+    ht_visit_chains(table->old_items + table->migrated,
+                    table->old_size - table->migrated, visit, ctx);
+  }
+}
+
+// Deletes all the items for which `pred` returns true, returns the number of
+// deleted items
+int ht_delete_if(ht_table_t *table, ht_visit_fn_t pred, void *ctx) {
+  int count = table->count;
+
+  ht_iter_t iter;
+  ht_iter_begin(table, &iter);
+  for (ht_item_t *item; (item = ht_iter_next(&iter));) {
+    if (pred(item, ctx)) {
+      ht_iter_delete(&iter);
+    }
+  }
+
+  // the table can shrink only after the iteration
+  if (count != table->count) {
+    ht_after_delete(table);
+  }
+  return count - table->count;
+}
+
+// Adds lengths of the chains to the histogram in stats
+static void ht_chain_histogram(ht_item_t **items, int size,
+                               ht_stats_t *stats) {
+  for (int i = 0; i < size; ++i) {
+    int length = 0;
+    for (ht_item_t *item = items[i]; item; item = item->next) {
+      ++length;
+    }
+    if (length > stats->max_chain) {
+      stats->max_chain = length;
+    }
+    ++stats->histogram[length < HT_HISTOGRAM ? length : HT_HISTOGRAM - 1];
+  }
+}
+
+// Gets the counters and the current shape of the table. The histogram walks
+// all the chains.
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->size = table->size;
+  stats->count = table->count;
+  stats->load = table->size ? (float)table->count / table->size : 0;
+
+  ht_chain_histogram(table->items, table->size, stats);
+  if (table->old_items) {
+    ht_chain_histogram(table->old_items + table->migrated,
+                       table->old_size - table->migrated, stats);
+  }
+}
+
+// Frees all the items in the buckets and clears the buckets. Items from
+// slab are not freed, they are released all at once.
+static void ht_free_chains(ht_table_t *table, ht_item_t **items, int size) {
+  if (table->slab.block_count) {
+    memset(items, 0, size * sizeof(*items));
+    return;
+  }
+
+  for (int i = 0; i < size; ++i) {
+    ht_item_t *item = items[i];
+    while (item) {
+      ht_item_t *to_free = item;
+      item = item->next;
+      ht_slab_free(&table->slab, to_free);
+    }
+    items[i] = NULL;
   }
 }
 
@@ -139,16 +869,38 @@ void ht_delete(ht_table_t *table, char *key) {
  * inicializaci.
  */
 void ht_delete_all(ht_table_t *table) {
-  // cast to more reasonable type
-  ht_item_t **tab = (ht_item_t **)table;
+  ht_free_chains(table, table->items, table->size);
 
-  for (int i = 0; i < HT_SIZE; ++i) {
-    ht_item_t *item = tab[i];
-    while (item) {
-      ht_item_t *to_free = item;
-      item = item->next;
-      free(to_free);
+  // the old array may still be there from unfinished migration
+  if (table->old_items) {
+    ht_free_chains(table, table->old_items + table->migrated,
+                   table->old_size - table->migrated);
+    free(table->old_items);
+    table->old_items = NULL;
+    table->old_size = 0;
+  }
+  ht_slab_release(&table->slab);
+  ht_arena_release(&table->keys);
+  ht_filter_clear(&table->filter);
+  table->count = 0;
+
+  // return to the size after initialization, there is nothing to move
+  if (table->size > table->min_size) {
+    ht_item_t **items = calloc(table->min_size, sizeof(*items));
+    if (items) {
+      free(table->items);
+      table->items = items;
+      table->size = table->min_size;
     }
-    tab[i] = NULL;
   }
 }
+
+// Frees all the items and the array of buckets. The table must be
+// initialized again before it is used.
+void ht_dispose(ht_table_t *table) {
+  ht_delete_all(table);
+  ht_filter_release(&table->filter);
+  free(table->items);
+  table->items = NULL;
+  table->size = 0;
+}
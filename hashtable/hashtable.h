@@ -6,37 +6,311 @@
 #ifndef IAL_HASHTABLE_H
 #define IAL_HASHTABLE_H
 
+#include "filter.h"
+#include "hash.h"
+#include "slab.h"
 #include <stdbool.h>
 
 /*
- * Maximálna veľkosť poľa pre implementáciu tabuľky.
- * Funkcie pracujúce s tabuľkou uvažujú veľkosť HT_SIZE.
+ * Predvolená počiatočná veľkosť tabuľky.
+ * Tabuľka sa zväčšuje a zmenšuje podľa počtu prvkov, takže to už nie je
+ * maximálna veľkosť.
  */
 #define MAX_HT_SIZE 101
 
 /*
- * Veľkosť tabuľky s ktorou pracujú implementované funkcie.
+ * Počiatočná veľkosť tabuliek vytvorených pomocou ht_init a veľkosť s ktorou
+ * pracuje get_hash.
  * Pre účely testovania je vhodné mať možnosť meniť veľkosť tabuľky.
  * Pre správne fungovanie musí byť veľkosť prvočíslom.
  */
 extern int HT_SIZE;
 
+// Predvolené hranice zaplnenia tabuľky pre zmenu jej veľkosti
+#define HT_MAX_LOAD 1.0f
+#define HT_MIN_LOAD 0.125f
+
 // Prvok tabuľky
 typedef struct ht_item {
   char *key;            // kľúč prvku
   float value;          // hodnota prvku
+  uint32_t length;      // dĺžka kľúča
   struct ht_item *next; // ukazateľ na ďalšie synonymum
+  uint64_t hash;        // celý hash kľúča
 } ht_item_t;
 
-// Tabuľka o reálnej veľkosti MAX_HT_SIZE
-typedef ht_item_t *ht_table_t[MAX_HT_SIZE];
+/*
+ * Počítadlá operácií s tabuľkou. Zbierajú sa len pri preklade s -DHT_STATS
+ * (`make STATS=1`), inak v tabuľke nie sú a HT_COUNT nerobí nič.
+ */
+typedef struct ht_counters {
+  long lookups;  // počet vyhľadaní
+  long hits;     // počet úspešných vyhľadaní
+  long misses;   // počet neúspešných vyhľadaní
+  long filtered; // neúspešné vyhľadania, ktoré odmietol filter
+  long visited;  // prejdené prvky (pri otvorenom adresovaní skupiny)
+  long inserts;  // počet vložených nových prvkov
+  long deletes;  // počet zmazaných prvkov
+  long rehashes; // počet zmien veľkosti tabuľky
+} ht_counters_t;
+
+#ifdef HT_STATS
+#define HT_COUNT(TABLE, COUNTER, N) ((TABLE)->counters.COUNTER += (N))
+#else
+#define HT_COUNT(TABLE, COUNTER, N) ((void)(N))
+#endif
+
+// Počet stĺpcov histogramu, posledný obsahuje aj všetky dlhšie zoznamy
+#define HT_HISTOGRAM 16
+
+/*
+ * Stav tabuľky vrátený z ht_stats. Histogram sa počíta pri volaní:
+ * histogram[i] je počet zoznamov synonym s dĺžkou i, pri otvorenom
+ * adresovaní počet prvkov nájdených po prejdení i skupín.
+ */
+typedef struct ht_stats {
+  ht_counters_t counters;      // počítadlá, nulové bez HT_STATS
+  int size;                    // veľkosť tabuľky
+  int count;                   // počet prvkov
+  float load;                  // zaplnenie count / size
+  int max_chain;               // dĺžka najdlhšieho zoznamu synonym
+  int histogram[HT_HISTOGRAM]; // histogram dĺžok zoznamov synonym
+} ht_stats_t;
+
+/*
+ * Maximálna dĺžka kľúča (vrátane ukončovacieho znaku), ktorý je pri vlastnení
+ * kľúčov uložený priamo za prvkom. Dlhšie kľúče sú uložené v aréne tabuľky.
+ */
+#define HT_SHORT_KEY 16
+
+// Tabuľka so zoznamami synonym sa použije, ak nie je zvolená iná
+#if !defined(HT_SWISS) && !defined(HT_CUCKOO)
+#define HT_CHAINED
+#endif
+
+#if defined(HT_SWISS)
+
+// Predvolené maximálne zaplnenie tabuľky s otvoreným adresovaním
+#define HT_SWISS_MAX_LOAD 0.875f
+
+/*
+ * Tabuľka s otvoreným adresovaním (Swiss table), prekladá sa s -DHT_SWISS.
+ * Prvky sú uložené priamo v poli slots (položka next sa nepoužíva), ku
+ * každému prvku patrí riadiaci bajt v poli ctrl so 7 bitmi z hashu kľúča,
+ * alebo značkou prázdneho/zmazaného miesta. Riadiace bajty sa prehľadávajú
+ * po skupinách o veľkosti HT_GROUP_SIZE.
+ *
+ * Ukazatele vrátené z ht_search a ht_get sú platné len do ďalšieho vloženia
+ * alebo zmazania prvku.
+ */
+#define HT_GROUP_SIZE 16
+
+typedef struct ht_table {
+  ht_item_t *slots;  // prvky tabuľky
+  signed char *ctrl; // riadiace bajty pre každý prvok
+  int size;          // počet miest v tabuľke, násobok HT_GROUP_SIZE
+  int min_size;      // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;         // počet prvkov v tabuľke
+  int deleted;       // počet zmazaných miest (tombstones)
+  float max_load;    // pri prekročení (count + deleted) / size sa zväčší
+  float min_load;    // pri poklese count / size pod túto hodnotu sa zmenší
+  ht_hash_fn_t hash; // rozptylovacia funkcia
+  uint64_t seed;     // seed pre rozptylovaciu funkciu
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá operácií
+#endif
+} ht_table_t;
+
+// Kurzor pre prechádzanie prvkov tabuľky, pozri ht_iter_begin
+typedef struct ht_iter {
+  ht_table_t *table; // prechádzaná tabuľka
+  int slot;          // index posledného vráteného prvku
+} ht_iter_t;
+
+#elif defined(HT_CUCKOO)
+
+// Predvolené maximálne zaplnenie kukučej tabuľky
+#define HT_CUCKOO_MAX_LOAD 0.9f
+
+// Počet miest v jednom koši kukučej tabuľky
+#define HT_CUCKOO_SLOTS 4
+
+/*
+ * Kukučia tabuľka (cuckoo hashing), prekladá sa s -DHT_CUCKOO.
+ * Každý kľúč môže byť len v jednom z dvoch košov s HT_CUCKOO_SLOTS miestami,
+ * ktoré sú určené rôznymi časťami jeho hashu. Ku každému miestu patrí bajt v
+ * poli tags s 8 bitmi z hashu (0 je voľné miesto). Vyhľadanie číta značky
+ * oboch košov (jeden alebo dva riadky cache), potom riadok s prvkom pre
+ * každú zhodnú značku a pri neúspechu ešte neprázdny stash, spravidla teda
+ * tri a viac riadkov. Značky nie sú v riadku s prvkami koša, pretože štyri
+ * 32-bajtové prvky sa do jedného 64-bajtového riadku nezmestia. Ak pri
+ * vkladaní nie sú voľné miesta v žiadnom z košov, prvky sa presúvajú do ich
+ * druhého koša a prvok, ktorý sa nepodarí umiestniť, sa uloží do poľa
+ * stash.
+ *
+ * Ukazatele vrátené z ht_search a ht_get sú platné len do ďalšieho vloženia
+ * alebo zmazania prvku.
+ */
+typedef struct ht_table {
+  ht_item_t *slots;  // prvky tabuľky
+  uint8_t *tags;     // značky pre každé miesto, 0 pre voľné miesto
+  int size;          // počet miest v tabuľke, násobok HT_CUCKOO_SLOTS
+  int min_size;      // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;         // počet prvkov v tabuľke aj v stash
+  ht_item_t *stash;  // prvky, ktoré sa nepodarilo umiestniť do košov
+  int stash_count;   // počet prvkov v stash
+  int stash_size;    // kapacita stash
+  float max_load;    // pri prekročení count / size sa tabuľka zväčší
+  float min_load;    // pri poklese count / size pod túto hodnotu sa zmenší
+  ht_hash_fn_t hash; // rozptylovacia funkcia
+  uint64_t seed;     // seed pre rozptylovaciu funkciu
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá operácií
+#endif
+} ht_table_t;
+
+// Kurzor pre prechádzanie prvkov tabuľky, pozri ht_iter_begin
+typedef struct ht_iter {
+  ht_table_t *table; // prechádzaná tabuľka
+  int slot;          // index posledného vráteného prvku, za size je stash
+} ht_iter_t;
+
+#else // HT_CHAINED
+
+// Preusporiadanie zoznamu synonym pri úspešnom vyhľadaní cez ht_search
+typedef enum ht_reorder {
+  HT_REORDER_NONE,      // zoznamy sa nemenia
+  HT_REORDER_FRONT,     // nájdený prvok sa presunie na začiatok zoznamu
+  HT_REORDER_TRANSPOSE, // nájdený prvok sa vymení s predchádzajúcim
+} ht_reorder_t;
+
+/*
+ * Tabuľka s dynamickou veľkosťou.
+ * Hodnoty max_load, min_load a rehash_budget je možné zmeniť po inicializácii,
+ * hodnota 0 v max_load/min_load vypína automatické zväčšovanie/zmenšovanie.
+ *
+ * Ak je rehash_budget 0, pri zmene veľkosti sa presunú všetky prvky naraz.
+ * Inak sa pri každej operácii presunie najviac rehash_budget zoznamov synonym
+ * zo starého poľa (old_items) do nového a kým presun neskončí, vyhľadáva sa v
+ * oboch poliach.
+ *
+ * S filtrom zapnutým cez ht_use_filter väčšina vyhľadaní a mazaní
+ * neexistujúcich kľúčov skončí vo filtri bez čítania zoznamov synonym.
+ */
+typedef struct ht_table {
+  ht_item_t **items;     // zoznamy synonym
+  int size;              // počet zoznamov synonym
+  int min_size;          // veľkosť pod ktorú sa tabuľka nezmenší
+  int count;             // počet prvkov v tabuľke
+  ht_item_t **old_items; // pôvodné pole počas presúvania, inak NULL
+  int old_size;          // počet zoznamov synonym v old_items
+  int migrated;          // počet už presunutých zoznamov z old_items
+  int rehash_budget;     // počet presunutých zoznamov na jednu operáciu
+  float max_load;        // pri prekročení count / size sa tabuľka zväčší
+  float min_load;        // pri poklese count / size pod túto hodnotu sa zmenší
+  ht_hash_fn_t hash;     // rozptylovacia funkcia
+  uint64_t seed;         // seed pre rozptylovaciu funkciu
+  ht_slab_t slab;        // alokátor prvkov, nastavuje sa cez ht_use_slab
+  bool own_keys;         // tabuľka si kľúče kopíruje, nastavuje ht_own_keys
+  ht_arena_t keys;       // dlhé kľúče ak own_keys
+  size_t value_size;     // veľkosť hodnôt za prvkom, nastavuje ht_use_values
+  ht_reorder_t reorder;  // preusporiadanie zoznamov pri vyhľadaní
+  ht_filter_t filter;    // filter neprítomných kľúčov, nastavuje ht_use_filter
+#ifdef HT_STATS
+  ht_counters_t counters; // počítadlá operácií
+#endif
+} ht_table_t;
+
+// Kurzor pre prechádzanie prvkov tabuľky, pozri ht_iter_begin
+typedef struct ht_iter {
+  ht_table_t *table; // prechádzaná tabuľka
+  ht_item_t **pos;   // pozícia posledného vráteného prvku, NULL na začiatku
+  int bucket;        // index zoznamu synonym, za size pokračuje old_items
+  bool deleted;      // posledný vrátený prvok bol zmazaný cez ht_iter_delete
+} ht_iter_t;
+
+bool ht_use_slab(ht_table_t *table, int block_count);
+bool ht_own_keys(ht_table_t *table, bool own);
+bool ht_use_values(ht_table_t *table, size_t value_size);
+bool ht_use_filter(ht_table_t *table, float fp_rate);
+void *ht_item_value(ht_item_t *item);
+void ht_insert_value(ht_table_t *table, char *key, const void *value);
+void *ht_get_value(ht_table_t *table, char *key);
+
+/*
+ * Makro generujúce funkcie pre tabuľku s hodnotami typu T s názvovým infixom
+ * TNAME. Pre TNAME="rec" pracujúce s typom T="rec_t":
+ *   Funkcie bool ht_rec_init(ht_table_t *table)
+ *           void ht_rec_insert(ht_table_t *table, char *key, rec_t value)
+ *           rec_t *ht_rec_get(ht_table_t *table, char *key)
+ * Hodnoty sú uložené priamo v prvkoch tabuľky, pozri ht_use_values. Sú
+ * zarovnané len ako ukazatele, typ s väčším zarovnaním sa nepreloží.
+ */
+#define HT_VALUEDEC(T, TNAME)                                                  \
+  _Static_assert(_Alignof(T) <= _Alignof(void *),                              \
+                 "values are aligned only as pointers");                       \
+                                                                               \
+  static inline bool ht_##TNAME##_init(ht_table_t *table) {                    \
+    ht_init(table);                                                            \
+    return ht_use_values(table, sizeof(T));                                    \
+  }                                                                            \
+                                                                               \
+  static inline void ht_##TNAME##_insert(ht_table_t *table, char *key,         \
+                                         T value) {                            \
+    ht_insert_value(table, key, &value);                                       \
+  }                                                                            \
+                                                                               \
+  static inline T *ht_##TNAME##_get(ht_table_t *table, char *key) {            \
+    return ht_get_value(table, key);                                           \
+  }
+
+#endif // HT_CHAINED
 
 int get_hash(char *key);
 void ht_init(ht_table_t *table);
+void ht_init_hash(ht_table_t *table, ht_hash_fn_t hash, uint64_t seed);
 ht_item_t *ht_search(ht_table_t *table, char *key);
 void ht_insert(ht_table_t *table, char *key, float data);
 float *ht_get(ht_table_t *table, char *key);
 void ht_delete(ht_table_t *table, char *key);
 void ht_delete_all(ht_table_t *table);
+void ht_dispose(ht_table_t *table);
+bool ht_resize(ht_table_t *table, int size);
+
+/*
+ * Varianty funkcií so známou dĺžkou a hashom kľúča (z ht_key_hash), ktoré
+ * ich nemusia znova počítať.
+ */
+uint64_t ht_key_hash(ht_table_t *table, const char *key, size_t length);
+ht_item_t *ht_search_hashed(ht_table_t *table, const char *key, size_t length,
+                            uint64_t hash);
+void ht_insert_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash, float value);
+float *ht_get_hashed(ht_table_t *table, const char *key, size_t length,
+                     uint64_t hash);
+void ht_delete_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash);
+
+void ht_get_batch(ht_table_t *table, char *keys[], int n, float *values[]);
+void ht_insert_batch(ht_table_t *table, char *keys[], float values[], int n);
+
+/*
+ * Prechádzanie všetkých prvkov tabuľky v poradí, v akom sú v pamäti.
+ * Počas prechádzania sa s tabuľkou nesmie robiť nič iné (ani vyhľadávať,
+ * vyhľadávanie môže presúvať prvky), okrem mazania aktuálneho prvku cez
+ * ht_iter_delete. Tabuľka sa pri ňom nezmenšuje.
+ *
+ * ht_for_each volá `visit` pre každý prvok, kým nevráti false.
+ * ht_delete_if zmaže prvky, pre ktoré `pred` vráti true, a vráti ich počet.
+ */
+typedef bool (*ht_visit_fn_t)(ht_item_t *item, void *ctx);
+
+void ht_iter_begin(ht_table_t *table, ht_iter_t *iter);
+ht_item_t *ht_iter_next(ht_iter_t *iter);
+void ht_iter_delete(ht_iter_t *iter);
+void ht_for_each(ht_table_t *table, ht_visit_fn_t visit, void *ctx);
+int ht_delete_if(ht_table_t *table, ht_visit_fn_t pred, void *ctx);
+
+void ht_stats(ht_table_t *table, ht_stats_t *stats);
 
 #endif
@@ -0,0 +1,116 @@
+/*
+ * Porovnání rozptylovacích funkcí na vlastních klíčích.
+ *
+ * Použití: ./report [soubor s klíči] [velikost tabulky]
+ * Klíče jsou načteny po řádcích, bez souboru ze standardního vstupu.
+ * Tabulky s otevřenou adresací se zvětší, aby se do nich vešly všechny klíče.
+ */
+
+#include "hashtable.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Frees the keys read by read_keys
+static void free_keys(char **keys, int count) {
+  for (int i = 0; i < count; ++i) {
+    free(keys[i]);
+  }
+  free(keys);
+}
+
+// Reads all the lines from the file to `keys`, returns false on read or
+// allocation failure
+static bool read_keys(FILE *in, char ***keys, int *count) {
+  int capacity = 0;
+  char line[4096];
+
+  *keys = NULL;
+  *count = 0;
+  while (fgets(line, sizeof(line), in)) {
+    line[strcspn(line, "\r\n")] = 0;
+    if (*count == capacity) {
+      capacity = capacity * 2 + 8;
+      char **grown = realloc(*keys, capacity * sizeof(**keys));
+      if (!grown) {
+        break;
+      }
+      *keys = grown;
+    }
+    char *key = malloc(strlen(line) + 1);
+    if (!key) {
+      break;
+    }
+    (*keys)[(*count)++] = strcpy(key, line);
+  }
+
+  // the loop stops before the end of the file only on failure
+  if (!feof(in)) {
+    free_keys(*keys, *count);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  FILE *in = argc > 1 ? fopen(argv[1], "r") : stdin;
+  if (!in) {
+    fprintf(stderr, "Failed to open '%s'\n", argv[1]);
+    return 1;
+  }
+
+  if (argc > 2) {
+    HT_SIZE = atoi(argv[2]);
+    if (HT_SIZE <= 0) {
+      fprintf(stderr, "Table size must be positive\n");
+      return 1;
+    }
+  }
+
+  char **keys;
+  int count;
+  bool ok = read_keys(in, &keys, &count);
+  if (in != stdin) {
+    fclose(in);
+  }
+  if (!ok) {
+    fprintf(stderr, "Failed to read the keys\n");
+    return 1;
+  }
+
+  printf("%d keys\n", count);
+  printf("%-10s %8s %8s %10s %10s\n", "hash", "size", "used", "max chain",
+         "avg chain");
+
+  ht_table_t table;
+  for (int h = 0; h < HT_HASH_COUNT; ++h) {
+    const ht_hash_info_t *info = &HT_HASHES[h];
+    ht_init_hash(&table, info->hash, info->seeded ? ht_random_seed() : 0);
+#ifndef HT_CHAINED
+    // open addressing table can't hold more keys than it has slots, so it is
+    // sized for the keys at its default load
+    ht_resize(&table, count / table.max_load + 1);
+#endif
+    // compare the hashes on fixed number of buckets
+    table.max_load = 0;
+    int dropped = 0;
+    for (int i = 0; i < count; ++i) {
+      ht_insert(&table, keys[i], i);
+      dropped += !ht_search(&table, keys[i]);
+    }
+    if (dropped) {
+      fprintf(stderr, "%s: %d keys didn't fit into the table\n", info->name,
+              dropped);
+    }
+
+    ht_chain_stats_t stats;
+    ht_chain_stats(&table, &stats);
+    printf("%-10s %8d %8d %10d %10.2f\n", info->name, table.size,
+           stats.used_buckets, stats.max_chain, ht_avg_chain(&stats));
+
+    ht_dispose(&table);
+  }
+
+  free_keys(keys, count);
+}
@@ -0,0 +1,174 @@
+/*
+ * Alokátor prvků tabulky s rozptýlenými položkami.
+ */
+
+#include "slab.h"
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Minimal size of arena chunk
+#define ARENA_CHUNK 4096
+
+// Objects in blocks are aligned to this
+#define SLAB_ALIGN alignof(void *)
+
+// Size of the block header rounded so that the first object is aligned
+#define SLAB_HEADER                                                            \
+  ((sizeof(ht_slab_block_t) + alignof(max_align_t) - 1) /                      \
+   alignof(max_align_t) * alignof(max_align_t))
+
+// Initializes allocator of objects with the given size
+void ht_slab_init(ht_slab_t *slab, size_t object_size, int block_count) {
+  // the free list is stored in the freed objects
+  if (object_size < sizeof(void *)) {
+    object_size = sizeof(void *);
+  }
+  slab->object_size = (object_size + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+  slab->block_count = block_count;
+  slab->blocks = NULL;
+  slab->free_list = NULL;
+  slab->unused = NULL;
+  slab->unused_count = 0;
+  slab->mallocs = 0;
+  slab->frees = 0;
+}
+
+// Allocates one object, returns NULL on failure
+void *ht_slab_alloc(ht_slab_t *slab) {
+  if (!slab->block_count) {
+    ++slab->mallocs;
+    return malloc(slab->object_size);
+  }
+
+  // reuse freed object
+  if (slab->free_list) {
+    void *object = slab->free_list;
+    slab->free_list = *(void **)object;
+    return object;
+  }
+
+  if (!slab->unused_count) {
+    ht_slab_block_t *block =
+        malloc(SLAB_HEADER + slab->object_size * slab->block_count);
+    if (!block) {
+      return NULL;
+    }
+    ++slab->mallocs;
+
+    block->next = slab->blocks;
+    slab->blocks = block;
+    slab->unused = (char *)block + SLAB_HEADER;
+    slab->unused_count = slab->block_count;
+  }
+
+  void *object = slab->unused;
+  slab->unused += slab->object_size;
+  --slab->unused_count;
+  return object;
+}
+
+// Returns the object to the allocator
+void ht_slab_free(ht_slab_t *slab, void *object) {
+  if (!slab->block_count) {
+    ++slab->frees;
+    free(object);
+    return;
+  }
+
+  *(void **)object = slab->free_list;
+  slab->free_list = object;
+}
+
+// Frees all the blocks at once, which frees all the objects allocated from
+// them. Returns false if the objects are allocated with malloc and so they
+// must be freed one by one with ht_slab_free.
+bool ht_slab_release(ht_slab_t *slab) {
+  if (!slab->block_count) {
+    return false;
+  }
+
+  while (slab->blocks) {
+    ht_slab_block_t *block = slab->blocks;
+    slab->blocks = block->next;
+    ++slab->frees;
+    free(block);
+  }
+
+  slab->free_list = NULL;
+  slab->unused = NULL;
+  slab->unused_count = 0;
+  return true;
+}
+
+// Initializes empty string arena
+void ht_arena_init(ht_arena_t *arena) {
+  arena->chunks = NULL;
+  arena->used = 0;
+  arena->garbage = 0;
+  arena->mallocs = 0;
+  arena->frees = 0;
+}
+
+// Makes sure that strings with total size of `size` bytes (including the
+// terminating nulls) can be added without allocation. Returns false on
+// failure.
+bool ht_arena_reserve(ht_arena_t *arena, size_t size) {
+  ht_arena_chunk_t *chunk = arena->chunks;
+  if (chunk && chunk->size - chunk->used >= size) {
+    return true;
+  }
+
+  // chunks grow with the arena, so that there is not too many of them
+  if (size < arena->used) {
+    size = arena->used;
+  }
+  if (size < ARENA_CHUNK) {
+    size = ARENA_CHUNK;
+  }
+
+  chunk = malloc(sizeof(*chunk) + size);
+  if (!chunk) {
+    return false;
+  }
+  ++arena->mallocs;
+
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->next = arena->chunks;
+  arena->chunks = chunk;
+  return true;
+}
+
+// Copies `length` characters of the string to the arena and adds the
+// terminating null. Returns NULL on failure.
+char *ht_arena_strdup(ht_arena_t *arena, const char *str, size_t length) {
+  if (!ht_arena_reserve(arena, length + 1)) {
+    return NULL;
+  }
+
+  ht_arena_chunk_t *chunk = arena->chunks;
+  char *result = chunk->data + chunk->used;
+  memcpy(result, str, length);
+  result[length] = 0;
+  chunk->used += length + 1;
+  arena->used += length + 1;
+  return result;
+}
+
+// Marks string with the given length as no longer used
+void ht_arena_forget(ht_arena_t *arena, size_t length) {
+  arena->garbage += length + 1;
+}
+
+// Frees all the strings in the arena
+void ht_arena_release(ht_arena_t *arena) {
+  while (arena->chunks) {
+    ht_arena_chunk_t *chunk = arena->chunks;
+    arena->chunks = chunk->next;
+    ++arena->frees;
+    free(chunk);
+  }
+  arena->used = 0;
+  arena->garbage = 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Alokátor prvků tabulky s rozptýlenými položkami.
+ */
+
+#ifndef IAL_HASHTABLE_SLAB_H
+#define IAL_HASHTABLE_SLAB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Block of objects, the objects follow right after the header
+typedef struct ht_slab_block {
+  struct ht_slab_block *next; // previously allocated block
+} ht_slab_block_t;
+
+/*
+ * Allocator of objects with the same size. Objects are carved from blocks
+ * with `block_count` objects each and freed objects are reused through
+ * intrusive free list. With `block_count` 0 each object is allocated
+ * separately with malloc.
+ *
+ * `mallocs` and `frees` count the calls to malloc and free made by the
+ * allocator.
+ */
+typedef struct ht_slab {
+  size_t object_size;      // size of one object
+  int block_count;         // number of objects in one block, 0 for malloc
+  ht_slab_block_t *blocks; // all the allocated blocks
+  void *free_list;         // freed objects ready to be reused
+  char *unused;            // start of the never used part of the last block
+  int unused_count;        // number of never used objects in the last block
+  long mallocs;            // number of calls to malloc
+  long frees;              // number of calls to free
+} ht_slab_t;
+
+void ht_slab_init(ht_slab_t *slab, size_t object_size, int block_count);
+void *ht_slab_alloc(ht_slab_t *slab);
+void ht_slab_free(ht_slab_t *slab, void *object);
+bool ht_slab_release(ht_slab_t *slab);
+
+// Part of the string arena, the strings are stored in `data`
+typedef struct ht_arena_chunk {
+  struct ht_arena_chunk *next; // previously allocated chunk
+  size_t size;                 // capacity of `data`
+  size_t used;                 // used bytes in `data`
+  char data[];
+} ht_arena_chunk_t;
+
+/*
+ * Arena for strings. Strings can't be freed one by one, the arena only
+ * counts how many bytes are no longer used (`garbage`), so that the owner
+ * can copy the live strings to new arena when it is worth it.
+ */
+typedef struct ht_arena {
+  ht_arena_chunk_t *chunks; // all the chunks, the first is being filled
+  size_t used;              // total number of allocated bytes
+  size_t garbage;           // number of bytes that are no longer used
+  long mallocs;             // number of calls to malloc
+  long frees;               // number of calls to free
+} ht_arena_t;
+
+void ht_arena_init(ht_arena_t *arena);
+bool ht_arena_reserve(ht_arena_t *arena, size_t size);
+char *ht_arena_strdup(ht_arena_t *arena, const char *str, size_t length);
+void ht_arena_forget(ht_arena_t *arena, size_t length);
+void ht_arena_release(ht_arena_t *arena);
+
+#endif
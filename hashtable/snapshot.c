@@ -0,0 +1,243 @@
+/*
+ * Uložení tabulky s rozptýlenými položkami do souboru, který se dá
+ * namapovat do paměti.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "snapshot.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_MAGIC "HTSNAP02"
+
+// Start of the snapshot file
+typedef struct ht_snapshot_header {
+  char magic[8];      // SNAPSHOT_MAGIC
+  char hash[16];      // name of the hash function in HT_HASHES
+  uint64_t seed;      // seed of the hash function
+  uint32_t size;      // number of buckets
+  uint32_t count;     // number of entries
+  uint64_t keys_size; // size of the keys section
+} ht_snapshot_header_t;
+
+// Gets offset of the entries in the file, they are aligned to 8 bytes
+static size_t ht_snapshot_entries_offset(uint32_t size) {
+  size_t offset = sizeof(ht_snapshot_header_t) +
+                  ((size_t)size + 1) * sizeof(uint32_t);
+  return (offset + 7) / 8 * 8;
+}
+
+// Collects pointers to all the items in the table to `items`, which must
+// have space for table->count items
+static void ht_snapshot_items(ht_table_t *table, ht_item_t **items) {
+  ht_iter_t iter;
+  ht_iter_begin(table, &iter);
+  for (int n = 0; n < table->count; ++n) {
+    items[n] = ht_iter_next(&iter);
+  }
+}
+
+// Writes the buckets, entries and keys of the items to the file
+static bool ht_snapshot_write(FILE *file, ht_snapshot_header_t *header,
+                              ht_item_t **items) {
+  uint32_t size = header->size;
+  uint32_t count = header->count;
+  uint32_t *buckets = calloc((size_t)size + 1, sizeof(*buckets));
+  uint32_t *fill = malloc(size * sizeof(*fill));
+  ht_snapshot_entry_t *entries = malloc(count * sizeof(*entries));
+  bool ok = buckets && fill && (entries || !count);
+
+  if (ok) {
+    // counting sort of the items by bucket
+    for (uint32_t i = 0; i < count; ++i) {
+      ++buckets[items[i]->hash % size + 1];
+    }
+    for (uint32_t i = 0; i < size; ++i) {
+      buckets[i + 1] += buckets[i];
+      fill[i] = buckets[i];
+    }
+
+    uint64_t key = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      ht_snapshot_entry_t *entry = &entries[fill[items[i]->hash % size]++];
+      entry->hash = items[i]->hash;
+      entry->key = key;
+      entry->length = items[i]->length;
+      entry->value = items[i]->value;
+      key += items[i]->length + 1;
+    }
+    header->keys_size = key;
+
+    static const char padding[8];
+    size_t buckets_end =
+        sizeof(*header) + ((size_t)size + 1) * sizeof(*buckets);
+    ok = fwrite(header, sizeof(*header), 1, file) == 1 &&
+         fwrite(buckets, sizeof(*buckets), size + 1, file) == size + 1 &&
+         fwrite(padding, 1, ht_snapshot_entries_offset(size) - buckets_end,
+                file) == ht_snapshot_entries_offset(size) - buckets_end &&
+         fwrite(entries, sizeof(*entries), count, file) == count;
+  }
+
+  // keys are written in the order of the items, same as their offsets
+  for (uint32_t i = 0; ok && i < count; ++i) {
+    ok = fwrite(items[i]->key, 1, items[i]->length + 1, file) ==
+         items[i]->length + 1;
+  }
+
+  free(buckets);
+  free(fill);
+  free(entries);
+  return ok;
+}
+
+// Saves all the items of the table to file, which can be opened with
+// ht_snapshot_open. The table must use hash function from HT_HASHES.
+// Returns false on failure.
+bool ht_snapshot_save(ht_table_t *table, const char *path) {
+#ifdef HT_CHAINED
+  // only float values are saved
+  if (table->value_size) {
+    return false;
+  }
+#endif
+
+  ht_snapshot_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  for (int i = 0; i < HT_HASH_COUNT && !header.hash[0]; ++i) {
+    if (HT_HASHES[i].hash == table->hash) {
+      strncpy(header.hash, HT_HASHES[i].name, sizeof(header.hash) - 1);
+    }
+  }
+  if (!header.hash[0]) {
+    return false;
+  }
+  header.seed = table->seed;
+  header.count = table->count;
+  // about one item per bucket
+  header.size = table->count ? table->count : 1;
+
+  ht_item_t **items = malloc(table->count * sizeof(*items));
+  if (!items && table->count) {
+    return false;
+  }
+  ht_snapshot_items(table, items);
+
+  FILE *file = fopen(path, "wb");
+  bool ok = file && ht_snapshot_write(file, &header, items);
+  if (file && fclose(file)) {
+    ok = false;
+  }
+
+  free(items);
+  return ok;
+}
+
+// Maps the snapshot file to memory. Returns false if it can't be opened or
+// if it isn't valid snapshot.
+bool ht_snapshot_open(ht_snapshot_t *snapshot, const char *path) {
+  snapshot->data = NULL;
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) || (size_t)st.st_size < sizeof(ht_snapshot_header_t)) {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the file is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  // the sizes in the header are checked against the file size before any
+  // section is read
+  const ht_snapshot_header_t *header = data;
+  size_t file_size = st.st_size;
+  size_t entries = ht_snapshot_entries_offset(header->size);
+  size_t keys = entries + (size_t)header->count * sizeof(ht_snapshot_entry_t);
+  bool fits = entries <= file_size && keys <= file_size &&
+              header->keys_size == file_size - keys;
+  ht_hash_fn_t hash = NULL;
+  for (int i = 0; i < HT_HASH_COUNT && !hash; ++i) {
+    if (!strncmp(header->hash, HT_HASHES[i].name, sizeof(header->hash))) {
+      hash = HT_HASHES[i].hash;
+    }
+  }
+
+  const uint32_t *buckets = (const uint32_t *)(header + 1);
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) ||
+      !hash || !header->size || !fits ||
+      buckets[header->size] != header->count) {
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  snapshot->data = data;
+  snapshot->data_size = st.st_size;
+  snapshot->buckets = buckets;
+  snapshot->entries = (const ht_snapshot_entry_t *)((char *)data + entries);
+  snapshot->keys = (char *)data + keys;
+  snapshot->keys_size = header->keys_size;
+  snapshot->size = header->size;
+  snapshot->count = header->count;
+  snapshot->hash = hash;
+  snapshot->seed = header->seed;
+  return true;
+}
+
+// Finds the entry with the key, NULL if the key is not in the snapshot
+const ht_snapshot_entry_t *ht_snapshot_search(ht_snapshot_t *snapshot,
+                                              const char *key) {
+  size_t length = strlen(key);
+  uint64_t hash = snapshot->hash(key, length, snapshot->seed);
+  uint64_t bucket = hash % snapshot->size;
+
+  // indexes from corrupt file are clamped, so that they stay in the entries
+  uint32_t count = snapshot->count;
+  uint32_t start = snapshot->buckets[bucket];
+  uint32_t stop = snapshot->buckets[bucket + 1];
+  start = start < count ? start : count;
+  stop = stop < count ? stop : count;
+
+  const ht_snapshot_entry_t *entry = snapshot->entries + start;
+  const ht_snapshot_entry_t *end = snapshot->entries + stop;
+  for (; entry < end; ++entry) {
+    // the key with its terminating null must be in the keys section
+    if (entry->hash != hash || entry->length != length ||
+        entry->key >= snapshot->keys_size ||
+        length >= snapshot->keys_size - entry->key) {
+      continue;
+    }
+    const char *entry_key = snapshot->keys + entry->key;
+    if (memcmp(key, entry_key, length) == 0 && !entry_key[length]) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Gets the value of the key, NULL if the key is not in the snapshot
+const float *ht_snapshot_get(ht_snapshot_t *snapshot, const char *key) {
+  const ht_snapshot_entry_t *entry = ht_snapshot_search(snapshot, key);
+  return entry ? &entry->value : NULL;
+}
+
+// Unmaps the snapshot, the pointers to its entries are no longer valid
+void ht_snapshot_close(ht_snapshot_t *snapshot) {
+  if (snapshot->data) {
+    munmap(snapshot->data, snapshot->data_size);
+    snapshot->data = NULL;
+  }
+}
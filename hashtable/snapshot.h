@@ -0,0 +1,55 @@
+/*
+ * Uložení tabulky s rozptýlenými položkami do souboru, který se dá
+ * namapovat do paměti.
+ */
+
+#ifndef IAL_HASHTABLE_SNAPSHOT_H
+#define IAL_HASHTABLE_SNAPSHOT_H
+
+#include "hashtable.h"
+
+// Item in the snapshot file, items of one bucket follow each other
+typedef struct ht_snapshot_entry {
+  uint64_t hash;   // celý hash kľúča
+  uint64_t key;    // pozícia kľúča v úseku kľúčov
+  uint32_t length; // dĺžka kľúča
+  float value;     // hodnota prvku
+} ht_snapshot_entry_t;
+
+/*
+ * Read-only table mapped from snapshot file. The file contains only offsets
+ * and the lookups work directly on the mapped memory, so opening it doesn't
+ * depend on the number of items.
+ *
+ * Opening checks that the sections fit into the file, the bucket indexes and
+ * key offsets are checked when they are read, so a corrupt file can't cause
+ * reads outside of the mapping.
+ *
+ * File layout (in the byte order of the machine that saved it):
+ *   header with the hash function, seed and sizes
+ *   uint32_t buckets[size + 1], items of bucket i are at indexes
+ *                               buckets[i] to buckets[i + 1] - 1
+ *   ht_snapshot_entry_t entries[count]
+ *   null-terminated keys
+ */
+typedef struct ht_snapshot {
+  void *data;                         // namapovaný súbor
+  size_t data_size;                   // veľkosť súboru
+  const uint32_t *buckets;            // začiatky zoznamov synonym
+  const ht_snapshot_entry_t *entries; // prvky zoradené podľa zoznamov
+  const char *keys;                   // úsek kľúčov
+  uint64_t keys_size;                 // veľkosť úseku kľúčov
+  int size;                           // počet zoznamov synonym
+  int count;                          // počet prvkov
+  ht_hash_fn_t hash;                  // rozptylovacia funkcia
+  uint64_t seed;                      // seed pre rozptylovaciu funkciu
+} ht_snapshot_t;
+
+bool ht_snapshot_save(ht_table_t *table, const char *path);
+bool ht_snapshot_open(ht_snapshot_t *snapshot, const char *path);
+const ht_snapshot_entry_t *ht_snapshot_search(ht_snapshot_t *snapshot,
+                                              const char *key);
+const float *ht_snapshot_get(ht_snapshot_t *snapshot, const char *key);
+void ht_snapshot_close(ht_snapshot_t *snapshot);
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Zátěžový test tabulky sdílené mezi vlákny, určený pro ThreadSanitizer.
+ *
+ * Použití: ./stress [počet kol]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define KEY_LEN 16
+#define KEYS 1000
+#define READERS 4
+#define WRITERS 2
+#define WRITER_OPS 20000
+
+static char keys[KEYS][KEY_LEN];
+static ht_concurrent_t table;
+static atomic_bool writing;
+static atomic_int errors;
+
+static uint64_t xorshift(uint64_t *rnd) {
+  *rnd ^= *rnd << 13;
+  *rnd ^= *rnd >> 7;
+  *rnd ^= *rnd << 17;
+  return *rnd;
+}
+
+// Inserts, updates and deletes random keys, the value of key `i` is always
+// `i` modulo KEYS
+static void *stress_writer(void *arg) {
+  uint64_t rnd = 88172645463325252ull + (uintptr_t)arg;
+  for (int i = 0; i < WRITER_OPS; ++i) {
+    uint64_t r = xorshift(&rnd);
+    int k = r % KEYS;
+    if ((r >> 32) % 4) {
+      htc_insert(&table, keys[k], k + KEYS * (i % 1000));
+    } else {
+      htc_delete(&table, keys[k]);
+    }
+  }
+  return NULL;
+}
+
+// Looks up random keys until the writers finish and checks the values
+static void *stress_reader(void *arg) {
+  uint64_t rnd = 0x9e3779b97f4a7c15ull + (uintptr_t)arg;
+  while (atomic_load(&writing)) {
+    int k = xorshift(&rnd) % KEYS;
+    float value;
+    if (htc_get(&table, keys[k], &value) && (int)value % KEYS != k) {
+      atomic_fetch_add(&errors, 1);
+    }
+  }
+  return NULL;
+}
+
+// Runs the readers and writers on new table
+static void stress_round(int round) {
+  if (!htc_init(&table, ht_hash_wy, round)) {
+    fprintf(stderr, "Failed to initialize the table\n");
+    exit(1);
+  }
+  table.locked_reads = round % 2;
+  atomic_store(&writing, true);
+
+  pthread_t readers[READERS];
+  pthread_t writers[WRITERS];
+  for (uintptr_t i = 0; i < READERS; ++i) {
+    pthread_create(&readers[i], NULL, stress_reader, (void *)i);
+  }
+  for (uintptr_t i = 0; i < WRITERS; ++i) {
+    pthread_create(&writers[i], NULL, stress_writer, (void *)i);
+  }
+  for (int i = 0; i < WRITERS; ++i) {
+    pthread_join(writers[i], NULL);
+  }
+  atomic_store(&writing, false);
+  for (int i = 0; i < READERS; ++i) {
+    pthread_join(readers[i], NULL);
+  }
+
+  // all the keys that are in the table must have the right value
+  int count = 0;
+  for (int k = 0; k < KEYS; ++k) {
+    float value;
+    if (htc_get(&table, keys[k], &value)) {
+      ++count;
+      if ((int)value % KEYS != k) {
+        atomic_fetch_add(&errors, 1);
+      }
+    }
+  }
+  if (count != table.count) {
+    atomic_fetch_add(&errors, 1);
+  }
+
+  htc_dispose(&table);
+}
+
+int main(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 10;
+  for (int i = 0; i < KEYS; ++i) {
+    snprintf(keys[i], KEY_LEN, "key%d", i);
+  }
+
+  for (int i = 0; i < rounds; ++i) {
+    stress_round(i);
+  }
+
+  if (atomic_load(&errors)) {
+    printf("\x1b[91m%d ERRORS\x1b[0m\n", atomic_load(&errors));
+    return 1;
+  }
+  printf("\x1b[92mALL PASS\x1b[0m\n");
+}
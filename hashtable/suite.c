@@ -0,0 +1,342 @@
+/*
+ * Sada měření tabulky s rozptýlenými položkami na různých druzích klíčů,
+ * výsledky jsou vypsány ve formátu CSV.
+ *
+ * Použití: ./suite [maximální počet klíčů] [rozptylovací funkce]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "hashtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(HT_SWISS)
+#define ENGINE_NAME "swiss"
+#elif defined(HT_CUCKOO)
+#define ENGINE_NAME "cuckoo"
+#else
+#define ENGINE_NAME "chained"
+#endif
+
+// Only every SAMPLE-th operation is timed on its own, so that reading the
+// clock doesn't dominate the throughput
+#define SAMPLE 8
+
+// The additive hash has only few distinct values, so larger tables would
+// take hours
+#define ADDITIVE_MAX_KEYS 10000
+
+// Writes the `i`-th key of the set to `buf`, returns its length
+typedef int (*suite_key_fn_t)(char *buf, size_t size, long i);
+
+// Set of keys that is measured
+typedef struct suite_set {
+  const char *name;
+  suite_key_fn_t key;
+  bool zipf; // hit lookups follow Zipf distribution instead of uniform
+} suite_set_t;
+
+// Gets the current time in nanoseconds
+static long long now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b) {
+  long long x = *(const long long *)a;
+  long long y = *(const long long *)b;
+  return (x > y) - (x < y);
+}
+
+// Gets the `p`-th percentile from sorted array
+static long long percentile(const long long *sorted, int count, double p) {
+  int i = (int)(p / 100 * (count - 1));
+  return sorted[i];
+}
+
+static uint64_t xorshift(uint64_t *rnd) {
+  *rnd ^= *rnd << 13;
+  *rnd ^= *rnd >> 7;
+  *rnd ^= *rnd << 17;
+  return *rnd;
+}
+
+// Mixes the number, so that consecutive numbers give unrelated results
+static uint64_t splitmix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Random looking alphanumeric keys with 12 characters
+static int key_uniform(char *buf, size_t size, long i) {
+  static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+  uint64_t x = splitmix(i);
+  int length = size > 12 ? 12 : (int)size - 1;
+  for (int j = 0; j < length; ++j) {
+    buf[j] = chars[x % 36];
+    x = j % 6 == 5 ? splitmix(x) : x / 36;
+  }
+  buf[length] = 0;
+  return length;
+}
+
+// Decimal numbers in order
+static int key_sequential(char *buf, size_t size, long i) {
+  return snprintf(buf, size, "%ld", i);
+}
+
+// Long keys that differ only at the end
+static int key_prefix(char *buf, size_t size, long i) {
+  return snprintf(buf, size, "https://example.com/api/v1/users/%ld", i);
+}
+
+// Groups of 5040 keys, whose first 7 letters are permutations of each other
+static int key_anagram(char *buf, size_t size, long i) {
+  char letters[] = "abcdefg";
+  char perm[8];
+  long p = i % 5040;
+  for (int j = 0; j < 7; ++j) {
+    int k = p % (7 - j);
+    p /= 7 - j;
+    perm[j] = letters[k];
+    memmove(letters + k, letters + k + 1, 7 - j - k);
+  }
+  perm[7] = 0;
+  return snprintf(buf, size, "%s%ld", perm, i / 5040);
+}
+
+static const suite_set_t SETS[] = {
+    {"uniform", key_uniform, false},
+    {"zipf", key_uniform, true},
+    {"sequential", key_sequential, false},
+    {"prefix", key_prefix, false},
+    {"anagram", key_anagram, false},
+};
+
+// Generates keys 0 to `count - 1` of the set into one block of memory. The
+// block is stored to `data` and must be freed with the returned array. On
+// failure NULL is returned and `data` is NULL too.
+static char **suite_keys(const suite_set_t *set, long count, char **data) {
+  char **keys = malloc(count * sizeof(*keys));
+  size_t *offsets = malloc(count * sizeof(*offsets));
+  size_t capacity = count * 16;
+  *data = malloc(capacity);
+  if (!keys || !offsets || !*data) {
+    free(keys);
+    free(offsets);
+    free(*data);
+    *data = NULL;
+    return NULL;
+  }
+
+  // the block can move when it grows, so store offsets first
+  size_t used = 0;
+  for (long i = 0; i < count; ++i) {
+    char buf[64];
+    int length = set->key(buf, sizeof(buf), i);
+    if (used + length + 1 > capacity) {
+      capacity *= 2;
+      char *grown = realloc(*data, capacity);
+      if (!grown) {
+        free(keys);
+        free(offsets);
+        free(*data);
+        *data = NULL;
+        return NULL;
+      }
+      *data = grown;
+    }
+    memcpy(*data + used, buf, length + 1);
+    offsets[i] = used;
+    used += length + 1;
+  }
+
+  for (long i = 0; i < count; ++i) {
+    keys[i] = *data + offsets[i];
+  }
+  free(offsets);
+  return keys;
+}
+
+// Gets `count` keys for lookups, either shuffled or from Zipf distribution
+// with exponent 1
+static char **suite_lookups(char **keys, int count, bool zipf) {
+  char **lookups = malloc(count * sizeof(*lookups));
+  if (!lookups) {
+    return NULL;
+  }
+  uint64_t rnd = 88172645463325252ull;
+
+  if (!zipf) {
+    memcpy(lookups, keys, count * sizeof(*keys));
+    for (int i = count - 1; i > 0; --i) {
+      int j = xorshift(&rnd) % (i + 1);
+      char *tmp = lookups[i];
+      lookups[i] = lookups[j];
+      lookups[j] = tmp;
+    }
+    return lookups;
+  }
+
+  double *cdf = malloc(count * sizeof(*cdf));
+  if (!cdf) {
+    free(lookups);
+    return NULL;
+  }
+  double sum = 0;
+  for (int i = 0; i < count; ++i) {
+    sum += 1.0 / (i + 1);
+    cdf[i] = sum;
+  }
+  for (int i = 0; i < count; ++i) {
+    double u = (xorshift(&rnd) >> 11) * 0x1p-53 * sum;
+    // first rank with cdf at least u
+    int lo = 0;
+    int hi = count - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cdf[mid] < u) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    // the keys are random, so the rank can be used as index
+    lookups[i] = keys[lo];
+  }
+  free(cdf);
+  return lookups;
+}
+
+// Prints one line of the results. `times` are the sampled latencies, they
+// are sorted by this function.
+static void suite_print(const char *hash, const char *set, int count,
+                        const char *op, int ops, long long total,
+                        long long *times, int samples) {
+  printf("%s,%s,%s,%d,%s,%.3f,%.1f", ENGINE_NAME, hash, set, count, op,
+         ops / (total / 1e3), (double)total / ops);
+  if (samples) {
+    qsort(times, samples, sizeof(*times), cmp_ll);
+    printf(",%lld,%lld,%lld\n", percentile(times, samples, 50),
+           percentile(times, samples, 99), percentile(times, samples, 99.9));
+  } else {
+    printf(",,,\n");
+  }
+}
+
+// Runs `op` on the table with each of the keys and prints the results. The
+// operations are identified by name, so that the loop is the same for all.
+static void suite_op(ht_table_t *table, const char *hash, const char *set,
+                     int count, const char *op, char **keys, int n,
+                     long long *times) {
+  bool insert = !strcmp(op, "insert");
+  bool delete = !strcmp(op, "delete");
+  int found = 0;
+  int samples = 0;
+
+  long long start = now_ns();
+  for (int i = 0; i < n; ++i) {
+    long long t = i % SAMPLE ? 0 : now_ns();
+    if (insert) {
+      ht_insert(table, keys[i], i);
+    } else if (delete) {
+      ht_delete(table, keys[i]);
+    } else {
+      found += ht_search(table, keys[i]) != NULL;
+    }
+    if (!(i % SAMPLE)) {
+      times[samples++] = now_ns() - t;
+    }
+  }
+  long long total = now_ns() - start;
+
+  if (!insert && !delete && found != (strcmp(op, "hit") ? 0 : n)) {
+    fprintf(stderr, "Wrong number of found keys in %s %s\n", set, op);
+  }
+  suite_print(hash, set, count, op, n, total, times, samples);
+}
+
+// Measures all the operations with `count` keys of the set
+static void suite_run(const ht_hash_info_t *hash, const suite_set_t *set,
+                      int count) {
+  char *data;
+  // the second half of the keys is used for misses
+  char **keys = suite_keys(set, 2l * count, &data);
+  char **lookups = keys ? suite_lookups(keys, count, set->zipf) : NULL;
+  long long *times = malloc((count / SAMPLE + 1) * sizeof(*times));
+  if (!keys || !lookups || !times) {
+    fprintf(stderr, "Failed to allocate %d keys\n", count);
+    free(keys);
+    free(lookups);
+    free(times);
+    free(data);
+    return;
+  }
+
+  ht_table_t table;
+  ht_init_hash(&table, hash->hash, hash->seeded ? ht_random_seed() : 0);
+
+  suite_op(&table, hash->name, set->name, count, "insert", keys, count,
+           times);
+  suite_op(&table, hash->name, set->name, count, "hit", lookups, count,
+           times);
+  suite_op(&table, hash->name, set->name, count, "miss", keys + count, count,
+           times);
+  // half of the keys is deleted one by one and the rest all at once
+  suite_op(&table, hash->name, set->name, count, "delete", keys, count / 2,
+           times);
+
+  int rest = table.count;
+  long long start = now_ns();
+  ht_delete_all(&table);
+  long long total = now_ns() - start;
+  suite_print(hash->name, set->name, count, "delete_all", rest ? rest : 1,
+              total, times, 0);
+
+  ht_dispose(&table);
+  free(keys);
+  free(lookups);
+  free(times);
+  free(data);
+}
+
+int main(int argc, char *argv[]) {
+  int max_count = argc > 1 ? atoi(argv[1]) : 1000000;
+  const char *only = argc > 2 ? argv[2] : NULL;
+  if (max_count <= 0) {
+    fprintf(stderr, "Invalid number of keys\n");
+    return 1;
+  }
+
+  bool known = !only;
+  for (int h = 0; h < HT_HASH_COUNT; ++h) {
+    known |= only && !strcmp(only, HT_HASHES[h].name);
+  }
+  if (!known) {
+    fprintf(stderr, "Unknown hash '%s'\n", only);
+    return 1;
+  }
+
+  printf("engine,hash,keys,count,op,mops,avg_ns,p50_ns,p99_ns,p999_ns\n");
+  for (int h = 0; h < HT_HASH_COUNT; ++h) {
+    if (only && strcmp(only, HT_HASHES[h].name)) {
+      continue;
+    }
+    for (size_t s = 0; s < sizeof(SETS) / sizeof(*SETS); ++s) {
+      for (int count = 1000; count <= max_count; count *= 10) {
+        if (HT_HASHES[h].hash == ht_hash_additive &&
+            count > ADDITIVE_MAX_KEYS) {
+          break;
+        }
+        suite_run(&HT_HASHES[h], &SETS[s], count);
+        fflush(stdout);
+      }
+    }
+  }
+}
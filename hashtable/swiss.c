@@ -0,0 +1,541 @@
+/*
+ * Tabulka s rozptýlenými položkami — otevřené adresování
+ *
+ * Implementace rozhraní ze souboru hashtable.h ve stylu Swiss table. Prvky
+ * jsou uloženy přímo v poli a k nim je paralelní pole řídicích bajtů, které
+ * se prohledávají po 16 najednou pomocí SSE2. Překládá se s -DHT_SWISS místo
+ * souboru hashtable.c.
+ */
+
+#include "hashtable.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Number of keys processed together by the batch functions
+#define BATCH_GROUP 16
+
+// Hint to the CPU to start loading the memory
+#ifdef __GNUC__
+#define PREFETCH(ADDR) __builtin_prefetch(ADDR)
+#else
+#define PREFETCH(ADDR) ((void)(ADDR))
+#endif
+
+// Control bytes of free slots, full slots have the low 7 bits of hash
+#define CTRL_EMPTY ((signed char)-128)
+#define CTRL_DELETED ((signed char)-2)
+
+int HT_SIZE = MAX_HT_SIZE;
+
+/*
+ * Rozptylovací funkce která přidělí zadanému klíči index z intervalu
+ * <0,HT_SIZE-1>. Ideální rozptylovací funkce by měla rozprostírat klíče
+ * rovnoměrně po všech indexech. Zamyslete sa nad kvalitou zvolené funkce.
+ */
+int get_hash(char *key) {
+  int result = 1;
+  int length = strlen(key);
+  for (int i = 0; i < length; i++) {
+    result += key[i];
+  }
+  return (result % HT_SIZE);
+}
+
+// Gets bit mask of the slots in the group that have the control byte `c`
+static unsigned ht_group_match(const signed char *group, signed char c) {
+#ifdef __SSE2__
+  __m128i g = _mm_load_si128((const __m128i *)group);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; ++i) {
+    mask |= (unsigned)(group[i] == c) << i;
+  }
+  return mask;
+#endif
+}
+
+// Gets bit mask of the slots in the group that are empty or deleted
+static unsigned ht_group_free(const signed char *group) {
+#ifdef __SSE2__
+  // empty and deleted are the only negative control bytes, so the sign bits
+  // are exactly the mask
+  return _mm_movemask_epi8(_mm_load_si128((const __m128i *)group));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < HT_GROUP_SIZE; ++i) {
+    mask |= (unsigned)(group[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+// Gets index of the lowest set bit, mask must not be 0
+static int ht_first_bit(unsigned mask) {
+#ifdef __GNUC__
+  return __builtin_ctz(mask);
+#else
+  int i = 0;
+  for (; !(mask & 1); mask >>= 1) {
+    ++i;
+  }
+  return i;
+#endif
+}
+
+// Gets the hash of key as used by the table, so that it can be passed to the
+// *_hashed functions
+uint64_t ht_key_hash(ht_table_t *table, const char *key, size_t length) {
+  return table->hash(key, length, table->seed);
+}
+
+// Gets the smallest valid table size that is not smaller than `size`
+static int ht_round_size(int size) {
+  int result = HT_GROUP_SIZE;
+  while (result < size) {
+    result *= 2;
+  }
+  return result;
+}
+
+// Allocates empty arrays with the given size, on failure the table has size
+// 0 and false is returned
+static bool ht_alloc(ht_table_t *table, int size) {
+  table->slots = malloc(size * sizeof(*table->slots));
+  table->ctrl = aligned_alloc(HT_GROUP_SIZE, size);
+  table->count = 0;
+  table->deleted = 0;
+
+  if (!table->slots || !table->ctrl) {
+    free(table->slots);
+    free(table->ctrl);
+    table->slots = NULL;
+    table->ctrl = NULL;
+    table->size = 0;
+    return false;
+  }
+
+  memset(table->ctrl, CTRL_EMPTY, size);
+  table->size = size;
+  return true;
+}
+
+/*
+ * Inicializace tabulky — zavolá sa před prvním použitím tabulky.
+ */
+void ht_init(ht_table_t *table) {
+  ht_init_hash(table, ht_hash_wy, 0);
+}
+
+// Initializes the table to use the given hash function
+void ht_init_hash(ht_table_t *table, ht_hash_fn_t hash, uint64_t seed) {
+  table->min_size = ht_round_size(HT_SIZE);
+  table->max_load = HT_SWISS_MAX_LOAD;
+  table->min_load = HT_MIN_LOAD;
+  table->hash = hash;
+  table->seed = seed;
+#ifdef HT_STATS
+  memset(&table->counters, 0, sizeof(table->counters));
+#endif
+  ht_alloc(table, table->min_size);
+}
+
+// Gets index of the slot with the key, -1 if the key is not in the table.
+// Groups are probed quadratically, which visits all of them because their
+// count is power of two.
+static int ht_find(ht_table_t *table, const char *key, size_t length,
+                   uint64_t hash) {
+  int mask = table->size / HT_GROUP_SIZE - 1;
+  int group = (hash >> 7) & mask;
+  signed char h2 = hash & 0x7f;
+
+  for (int step = 1; step <= mask + 1; ++step) {
+    signed char *ctrl = table->ctrl + group * HT_GROUP_SIZE;
+    HT_COUNT(table, visited, 1);
+
+    for (unsigned m = ht_group_match(ctrl, h2); m; m &= m - 1) {
+      int i = group * HT_GROUP_SIZE + ht_first_bit(m);
+      ht_item_t *slot = &table->slots[i];
+      if (slot->hash == hash && slot->length == length &&
+          memcmp(key, slot->key, length) == 0) {
+        return i;
+      }
+    }
+
+    // the key would be inserted to the empty slot, so it can't be further
+    if (ht_group_match(ctrl, CTRL_EMPTY)) {
+      return -1;
+    }
+
+    group = (group + step) & mask;
+  }
+
+  return -1;
+}
+
+// Gets index of the first empty or deleted slot for the hash, -1 if the
+// table is full
+static int ht_find_free(ht_table_t *table, uint64_t hash) {
+  int mask = table->size / HT_GROUP_SIZE - 1;
+  int group = (hash >> 7) & mask;
+
+  for (int step = 1; step <= mask + 1; ++step) {
+    unsigned m = ht_group_free(table->ctrl + group * HT_GROUP_SIZE);
+    if (m) {
+      return group * HT_GROUP_SIZE + ht_first_bit(m);
+    }
+    group = (group + step) & mask;
+  }
+
+  return -1;
+}
+
+// Moves all the items to new arrays with at least the given size. If the
+// allocation fails, the table is left unchanged and false is returned.
+bool ht_resize(ht_table_t *table, int size) {
+  ht_table_t old = *table;
+
+  // keep at least one free slot
+  size = ht_round_size(size > old.count ? size : old.count + 1);
+  if (!ht_alloc(table, size)) {
+    *table = old;
+    return false;
+  }
+
+  for (int i = 0; i < old.size; ++i) {
+    if (old.ctrl[i] < 0) {
+      continue;
+    }
+    uint64_t hash = old.slots[i].hash;
+    int j = ht_find_free(table, hash);
+    table->ctrl[j] = hash & 0x7f;
+    table->slots[j] = old.slots[i];
+  }
+  table->count = old.count;
+  HT_COUNT(table, rehashes, 1);
+
+  free(old.slots);
+  free(old.ctrl);
+  return true;
+}
+
+/*
+ * Vyhledání prvku v tabulce.
+ *
+ * V případě úspěchu vrací ukazatel na nalezený prvek; v opačném případě vrací
+ * hodnotu NULL.
+ */
+ht_item_t *ht_search(ht_table_t *table, char *key) {
+  size_t length = strlen(key);
+  return ht_search_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Same as ht_search, but with already known length and hash of the key
+ht_item_t *ht_search_hashed(ht_table_t *table, const char *key, size_t length,
+                            uint64_t hash) {
+  if (!table->size) {
+    return NULL;
+  }
+
+  int i = ht_find(table, key, length, hash);
+  HT_COUNT(table, lookups, 1);
+  HT_COUNT(table, hits, i >= 0);
+  HT_COUNT(table, misses, i < 0);
+  return i < 0 ? NULL : &table->slots[i];
+}
+
+/*
+ * Vložení nového prvku do tabulky.
+ *
+ * Pokud prvek s daným klíčem už v tabulce existuje, nahraďte jeho hodnotu.
+ */
+void ht_insert(ht_table_t *table, char *key, float value) {
+  size_t length = strlen(key);
+  ht_insert_hashed(table, key, length, ht_key_hash(table, key, length),
+                   value);
+}
+
+// Same as ht_insert, but with already known length and hash of the key. The
+// key must be null-terminated.
+void ht_insert_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash, float value) {
+  if (!table->size) {
+    return;
+  }
+
+  int i = ht_find(table, key, length, hash);
+
+  if (i >= 0) {
+    // modify existing
+    table->slots[i].value = value;
+    return;
+  }
+
+  // grow before inserting, tombstones also make the probes longer
+  if (table->max_load &&
+      table->count + table->deleted + 1 > table->size * table->max_load) {
+    // if there are mostly tombstones, it is enough to clean them up
+    bool grow = table->count + 1 > table->size * table->max_load / 2;
+    ht_resize(table, grow ? table->size * 2 : table->size);
+  }
+
+  i = ht_find_free(table, hash);
+  if (i < 0) {
+    return;
+  }
+
+  if (table->ctrl[i] == CTRL_DELETED) {
+    --table->deleted;
+  }
+  table->ctrl[i] = hash & 0x7f;
+  table->slots[i].key = (char *)key;
+  table->slots[i].value = value;
+  table->slots[i].length = length;
+  table->slots[i].next = NULL;
+  table->slots[i].hash = hash;
+  ++table->count;
+  HT_COUNT(table, inserts, 1);
+}
+
+/*
+ * Získání hodnoty z tabulky.
+ *
+ * V případě úspěchu vrací funkce ukazatel na hodnotu prvku, v opačném
+ * případě hodnotu NULL.
+ */
+float *ht_get(ht_table_t *table, char *key) {
+  ht_item_t *i = ht_search(table, key);
+  return i ? &i->value : NULL;
+}
+
+// Same as ht_get, but with already known length and hash of the key
+float *ht_get_hashed(ht_table_t *table, const char *key, size_t length,
+                     uint64_t hash) {
+  ht_item_t *i = ht_search_hashed(table, key, length, hash);
+  return i ? &i->value : NULL;
+}
+
+// Frees the slot with index `i`
+static void ht_delete_slot(ht_table_t *table, int i) {
+  // if the group has empty slot, no probe ever continued past it and so the
+  // slot can be empty instead of tombstone
+  signed char *group = table->ctrl + i / HT_GROUP_SIZE * HT_GROUP_SIZE;
+  if (ht_group_match(group, CTRL_EMPTY)) {
+    table->ctrl[i] = CTRL_EMPTY;
+  } else {
+    table->ctrl[i] = CTRL_DELETED;
+    ++table->deleted;
+  }
+  --table->count;
+  HT_COUNT(table, deletes, 1);
+}
+
+// Shrinks the table if there are too few items
+static void ht_shrink_sparse(ht_table_t *table) {
+  // shrink so that the memory is released after mass delete
+  if (table->min_load && table->size > table->min_size &&
+      table->count < table->size * table->min_load) {
+    ht_resize(table, table->size / 2);
+  }
+}
+
+/*
+ * Smazání prvku z tabulky.
+ *
+ * Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_delete(ht_table_t *table, char *key) {
+  size_t length = strlen(key);
+  ht_delete_hashed(table, key, length, ht_key_hash(table, key, length));
+}
+
+// Same as ht_delete, but with already known length and hash of the key
+void ht_delete_hashed(ht_table_t *table, const char *key, size_t length,
+                      uint64_t hash) {
+  if (!table->size) {
+    return;
+  }
+
+  int i = ht_find(table, key, length, hash);
+  if (i < 0) {
+    return;
+  }
+
+  ht_delete_slot(table, i);
+  ht_shrink_sparse(table);
+}
+
+// Starts loading the first group probed for the hash
+static void ht_prefetch_group(ht_table_t *table, uint64_t hash) {
+  if (table->size) {
+    int group = (hash >> 7) & (table->size / HT_GROUP_SIZE - 1);
+    PREFETCH(table->ctrl + group * HT_GROUP_SIZE);
+    PREFETCH(table->slots + group * HT_GROUP_SIZE);
+  }
+}
+
+// Stores the result of ht_get for keys[i] to values[i]. The memory loads
+// for multiple keys overlap, so it is faster than calling ht_get in loop.
+void ht_get_batch(ht_table_t *table, char *keys[], int n, float *values[]) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    // hash the keys and start loading the first group of each
+    for (int j = 0; j < group; ++j) {
+      lengths[j] = strlen(keys[i + j]);
+      hashes[j] = ht_key_hash(table, keys[i + j], lengths[j]);
+      ht_prefetch_group(table, hashes[j]);
+    }
+
+    for (int j = 0; j < group; ++j) {
+      values[i + j] = ht_get_hashed(table, keys[i + j], lengths[j], hashes[j]);
+    }
+  }
+}
+
+// Same as calling ht_insert for all the pairs keys[i], values[i]
+void ht_insert_batch(ht_table_t *table, char *keys[], float values[], int n) {
+  size_t lengths[BATCH_GROUP];
+  uint64_t hashes[BATCH_GROUP];
+
+  for (int i = 0; i < n; i += BATCH_GROUP) {
+    int group = n - i < BATCH_GROUP ? n - i : BATCH_GROUP;
+
+    for (int j = 0; j < group; ++j) {
+      lengths[j] = strlen(keys[i + j]);
+      hashes[j] = ht_key_hash(table, keys[i + j], lengths[j]);
+      ht_prefetch_group(table, hashes[j]);
+    }
+
+    for (int j = 0; j < group; ++j) {
+      ht_insert_hashed(table, keys[i + j], lengths[j], hashes[j],
+                       values[i + j]);
+    }
+  }
+}
+
+// Starts iteration over the items of the table
+void ht_iter_begin(ht_table_t *table, ht_iter_t *iter) {
+  iter->table = table;
+  iter->slot = -1;
+}
+
+// Gets the next item of the iteration, NULL if there are no more items
+ht_item_t *ht_iter_next(ht_iter_t *iter) {
+  ht_table_t *table = iter->table;
+  while (++iter->slot < table->size) {
+    if (table->ctrl[iter->slot] >= 0) {
+      return &table->slots[iter->slot];
+    }
+  }
+  iter->slot = table->size;
+  return NULL;
+}
+
+// Deletes the item last returned by ht_iter_next
+void ht_iter_delete(ht_iter_t *iter) {
+  ht_table_t *table = iter->table;
+  if (iter->slot >= 0 && iter->slot < table->size &&
+      table->ctrl[iter->slot] >= 0) {
+    ht_delete_slot(table, iter->slot);
+  }
+}
+
+// Calls `visit` for all the items until it returns false. Whole groups of
+// control bytes are checked at once.
+void ht_for_each(ht_table_t *table, ht_visit_fn_t visit, void *ctx) {
+  for (int group = 0; group < table->size; group += HT_GROUP_SIZE) {
+    unsigned full = ~ht_group_free(table->ctrl + group) &
+                    ((1u << HT_GROUP_SIZE) - 1);
+    if (full && group + HT_GROUP_SIZE < table->size) {
+      PREFETCH(table->slots + group + HT_GROUP_SIZE);
+    }
+    for (; full; full &= full - 1) {
+      if (!visit(&table->slots[group + ht_first_bit(full)], ctx)) {
+        return;
+      }
+    }
+  }
+}
+
+// Deletes all the items for which `pred` returns true, returns the number of
+// deleted items
+int ht_delete_if(ht_table_t *table, ht_visit_fn_t pred, void *ctx) {
+  int count = table->count;
+  for (int i = 0; i < table->size; ++i) {
+    if (table->ctrl[i] >= 0 && pred(&table->slots[i], ctx)) {
+      ht_delete_slot(table, i);
+    }
+  }
+
+  // the table can shrink only after the iteration
+  if (count != table->count) {
+    ht_shrink_sparse(table);
+  }
+  return count - table->count;
+}
+
+// Gets the counters and the current shape of the table. The histogram
+// counts how many groups are probed to find each item.
+void ht_stats(ht_table_t *table, ht_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+#ifdef HT_STATS
+  stats->counters = table->counters;
+#endif
+  stats->size = table->size;
+  stats->count = table->count;
+  stats->load = table->size ? (float)table->count / table->size : 0;
+
+  int mask = table->size / HT_GROUP_SIZE - 1;
+  for (int i = 0; i < table->size; ++i) {
+    if (table->ctrl[i] < 0) {
+      continue;
+    }
+    int group = i / HT_GROUP_SIZE;
+    int length = 1;
+    for (int g = (table->slots[i].hash >> 7) & mask; g != group;
+         g = (g + length++) & mask)
+      ;
+    if (length > stats->max_chain) {
+      stats->max_chain = length;
+    }
+    ++stats->histogram[length < HT_HISTOGRAM ? length : HT_HISTOGRAM - 1];
+  }
+}
+
+/*
+ * Smazání všech prvků z tabulky.
+ *
+ * Funkce uvede tabulku do stavu po inicializaci.
+ */
+void ht_delete_all(ht_table_t *table) {
+  if (table->size > table->min_size) {
+    free(table->slots);
+    free(table->ctrl);
+    ht_alloc(table, table->min_size);
+    return;
+  }
+
+  if (table->size) {
+    memset(table->ctrl, CTRL_EMPTY, table->size);
+  }
+  table->count = 0;
+  table->deleted = 0;
+}
+
+// Frees the arrays. The table must be initialized again before it is used.
+void ht_dispose(ht_table_t *table) {
+  free(table->slots);
+  free(table->ctrl);
+  table->slots = NULL;
+  table->ctrl = NULL;
+  table->size = 0;
+  table->count = 0;
+  table->deleted = 0;
+}
@@ -1,7 +1,13 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "concurrent.h"
+#include "frozen.h"
 #include "hashtable.h"
+#include "snapshot.h"
 #include "test_util.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define INSERT_TEST_DATA(TABLE)                                                \
   ht_insert_many(TABLE, TEST_DATA, sizeof(TEST_DATA) / sizeof(TEST_DATA[0]));
@@ -93,6 +99,669 @@ TEST(test_delete_all, "Delete all the items")
   }
 ENDTEST
 
+TEST(test_hash_anagrams, "Anagrams don't collide")
+  ht_init(test_table);
+  char *keys[] = {"listen", "silent", "enlist", "tinsel", "inlets"};
+  for (int i = 0; i < 5; ++i) {
+    ht_insert(test_table, keys[i], i);
+  }
+  ht_chain_stats_t stats;
+  ht_chain_stats(test_table, &stats);
+  success &= stats.items == 5 && stats.max_chain < 5;
+ENDTEST
+
+#ifdef HT_CHAINED
+
+TEST(test_hash_legacy, "Legacy additive hash")
+  ht_init_hash(test_table, ht_hash_additive, 0);
+  test_table->max_load = 0;
+  INSERT_TEST_DATA(test_table)
+  ht_item_t *f = ht_search(test_table, "Terra");
+  success &= f && test_table->items[get_hash("Terra")] != NULL;
+  success &= f && f->value == 30.67f;
+ENDTEST
+
+// Record stored as value of the table
+typedef struct test_record {
+  double price;
+  int volume[5];
+  char symbol[4];
+} test_record_t;
+
+HT_VALUEDEC(test_record_t, rec)
+
+TEST(test_values, "Store records as values")
+  success &= ht_rec_init(test_table);
+  success &= ht_own_keys(test_table, true);
+  char key[64];
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    test_record_t rec = {i * 0.5, {i, i + 1, i + 2, i + 3, i + 4}, "BTC"};
+    ht_rec_insert(test_table, key, rec);
+  }
+  test_record_t update = {-1, {0}, "ETH"};
+  ht_rec_insert(test_table, "k1", update);
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    test_record_t *rec = ht_rec_get(test_table, key);
+    success &= i == 1 ? rec && rec->price == -1 && !strcmp(rec->symbol, "ETH")
+                      : rec && rec->price == i * 0.5 &&
+                            rec->volume[4] == i + 4 &&
+                            !strcmp(rec->symbol, "BTC");
+  }
+  // the value doesn't overwrite short key stored after it
+  ht_item_t *item = ht_search(test_table, "k3");
+  success &= item && !strcmp(item->key, "k3") &&
+             ht_item_value(item) == ht_rec_get(test_table, "k3");
+  ht_delete(test_table, "k3");
+  success &= !ht_rec_get(test_table, "k3") && test_table->count == 999;
+ENDTEST
+
+#endif // HT_CHAINED
+
+char MANY_KEYS[1000][8];
+
+TEST(test_resize_grow, "Grow the table past its initial size")
+  ht_init(test_table);
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "k%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  success &= test_table->count == 1000 && test_table->size >= 1000;
+  for (int i = 0; i < 1000; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= f && *f == i;
+  }
+  printf("Items: %d, buckets: %d\n", test_table->count, test_table->size);
+  ht_delete_all(test_table);
+ENDTEST
+
+TEST(test_resize_shrink, "Shrink the table after mass delete")
+  ht_init(test_table);
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "k%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  for (int i = 10; i < 1000; ++i) {
+    ht_delete(test_table, MANY_KEYS[i]);
+  }
+  success &= test_table->count == 10 && test_table->size < 100;
+  for (int i = 0; i < 10; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= f && *f == i;
+  }
+ENDTEST
+
+#ifdef HT_CHAINED
+
+TEST(test_resize_incremental, "Grow the table incrementally")
+  ht_init(test_table);
+  test_table->rehash_budget = 1;
+  bool migrating = false;
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "k%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+    migrating |= test_table->old_items != NULL;
+    // all the previous items must be visible during the migration
+    for (int j = 0; j <= i; j += 7) {
+      float *f = ht_get(test_table, MANY_KEYS[j]);
+      success &= f && *f == j;
+    }
+  }
+  success &= migrating;
+  for (int i = 0; i < 1000; i += 2) {
+    ht_delete(test_table, MANY_KEYS[i]);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= i % 2 ? f && *f == i : !f;
+  }
+  success &= test_table->count == 500;
+  ht_delete_all(test_table);
+ENDTEST
+
+TEST(test_slab, "Allocate items from slab")
+  ht_init(test_table);
+  success &= ht_use_slab(test_table, 256);
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "k%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  // 1000 items fit to 4 blocks
+  success &= test_table->slab.mallocs == 4;
+  for (int i = 0; i < 500; ++i) {
+    ht_delete(test_table, MANY_KEYS[i]);
+  }
+  for (int i = 0; i < 500; ++i) {
+    ht_insert(test_table, MANY_KEYS[i], -i);
+  }
+  // the deleted items are reused
+  success &= test_table->slab.mallocs == 4 && test_table->slab.frees == 0;
+  for (int i = 0; i < 1000; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= f && *f == (i < 500 ? -i : i);
+  }
+  success &= !ht_use_slab(test_table, 0);
+  ht_delete_all(test_table);
+  success &= test_table->slab.frees == 4;
+ENDTEST
+
+TEST(test_own_keys, "Copy the inserted keys")
+  ht_init(test_table);
+  success &= ht_own_keys(test_table, true);
+  char key[64];
+  for (int i = 0; i < 1000; ++i) {
+    // every other key is too long to be stored in the item
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    ht_insert(test_table, key, i);
+  }
+  memset(key, 0, sizeof(key));
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    ht_item_t *item = ht_search(test_table, key);
+    success &= item && item->value == i && item->key != key;
+  }
+  // deleted long keys are eventually removed from the arena
+  for (int i = 0; i < 900; ++i) {
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    ht_delete(test_table, key);
+  }
+  success &= test_table->keys.frees > 0;
+  success &= test_table->keys.garbage <= test_table->keys.used / 2 + 4096;
+  for (int i = 900; i < 1000; ++i) {
+    sprintf(key, i % 2 ? "k%d" : "long key that is stored in arena %d", i);
+    float *f = ht_get(test_table, key);
+    success &= f && *f == i;
+  }
+ENDTEST
+
+#endif // HT_CHAINED
+
+TEST(test_hashed, "Use precomputed hashes")
+  ht_init(test_table);
+  INSERT_TEST_DATA(test_table)
+  // the key doesn't have to be null-terminated for lookups
+  char *key = "Terra Classic";
+  uint64_t hash = ht_key_hash(test_table, key, 5);
+  float *f = ht_get_hashed(test_table, key, 5, hash);
+  success &= f && *f == 30.67f;
+  hash = ht_key_hash(test_table, key, 4);
+  success &= !ht_get_hashed(test_table, key, 4, hash);
+  hash = ht_key_hash(test_table, key, 5);
+  ht_insert_hashed(test_table, "Terra", 5, hash, 1.5);
+  f = ht_get(test_table, "Terra");
+  success &= f && *f == 1.5f;
+  ht_delete_hashed(test_table, key, 5, hash);
+  success &= !ht_get(test_table, "Terra") && test_table->count == 14;
+ENDTEST
+
+TEST(test_simd, "Hash and compare keys with all instruction sets")
+  char data[300 + 4];
+  for (int i = 0; i < (int)sizeof(data); ++i) {
+    data[i] = 'a' + i * 7 % 26;
+  }
+  // unaligned keys of all lengths around the stripes get the same hash
+  for (size_t length = 0; length <= 300; ++length) {
+    for (int offset = 0; offset < 4; ++offset) {
+      uint64_t hash = ht_hash_vec_simd(data + offset, length, 7,
+                                       HT_SIMD_SCALAR);
+      success &= ht_hash_vec_simd(data + offset, length, 7, HT_SIMD_SSE2) ==
+                     hash &&
+                 ht_hash_vec_simd(data + offset, length, 7, HT_SIMD_AVX2) ==
+                     hash &&
+                 ht_hash_vec(data + offset, length, 7) == hash;
+    }
+  }
+  success &= ht_hash_vec(data, 100, 0) != ht_hash_vec(data + 1, 100, 0);
+
+  // the keys are exactly as long as compared, so reading past them would
+  // be caught by the address sanitizer
+  for (size_t length = 1; length <= 100; ++length) {
+    char *a = malloc(length);
+    char *b = malloc(length);
+    if (!a || !b) {
+      free(a);
+      free(b);
+      success = false;
+      break;
+    }
+    memcpy(a, data, length);
+    memcpy(b, data, length);
+    for (ht_simd_t simd = HT_SIMD_SCALAR; simd <= HT_SIMD_AVX2; ++simd) {
+      success &= ht_key_equal_simd(a, b, length, simd);
+      for (size_t i = 0; i < length; ++i) {
+        b[i] ^= 1;
+        success &= !ht_key_equal_simd(a, b, length, simd);
+        b[i] ^= 1;
+      }
+    }
+    free(a);
+    free(b);
+  }
+
+  // long keys in table with the vector hash
+  static char long_keys[100][64];
+  ht_init_hash(test_table, ht_hash_vec, 3);
+  for (int i = 0; i < 100; ++i) {
+    sprintf(long_keys[i], "%048d", i);
+    ht_insert(test_table, long_keys[i], i);
+  }
+  for (int i = 0; i < 100; ++i) {
+    float *f = ht_get(test_table, long_keys[i]);
+    success &= f && *f == i;
+  }
+ENDTEST
+
+TEST(test_batch, "Insert and get many items at once")
+  ht_init(test_table);
+  char *keys[1100];
+  float values[1000];
+  float *results[1100];
+  char missing[100][16];
+  for (int i = 0; i < 1100; ++i) {
+    if (i < 1000) {
+      sprintf(MANY_KEYS[i], "k%d", i);
+      keys[i] = MANY_KEYS[i];
+      values[i] = i;
+    } else {
+      sprintf(missing[i - 1000], "missing%d", i);
+      keys[i] = missing[i - 1000];
+    }
+  }
+  // the first 100 keys are not inserted, so they are missing too
+  ht_insert_batch(test_table, keys + 100, values + 100, 900);
+  ht_get_batch(test_table, keys, 1100, results);
+  for (int i = 0; i < 1100; ++i) {
+    success &= i >= 100 && i < 1000 ? results[i] && *results[i] == i
+                                    : !results[i];
+  }
+  success &= test_table->count == 900;
+ENDTEST
+
+TEST(test_tombstones, "Reuse deleted slots")
+  ht_init(test_table);
+  INSERT_TEST_DATA(test_table)
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      sprintf(MANY_KEYS[i], "r%d", round * 100 + i);
+      ht_insert(test_table, MANY_KEYS[i], i);
+    }
+    for (int i = 0; i < 100; ++i) {
+      ht_delete(test_table, MANY_KEYS[i]);
+    }
+  }
+  size_t data_size = sizeof(TEST_DATA) / sizeof(*TEST_DATA);
+  for (const ht_item_t *data = TEST_DATA; data_size; --data_size, ++data) {
+    float *f = ht_get(test_table, data->key);
+    success &= f && *f == data->value;
+  }
+  success &= test_table->count == 15;
+ENDTEST
+
+#define CONCURRENT_THREADS 4
+
+static ht_concurrent_t concurrent_table;
+
+// Inserts every CONCURRENT_THREADS-th key from MANY_KEYS and then deletes
+// every other of them
+static void *concurrent_worker(void *arg) {
+  int first = *(int *)arg;
+  for (int i = first; i < 1000; i += CONCURRENT_THREADS) {
+    htc_insert(&concurrent_table, MANY_KEYS[i], i);
+  }
+  for (int i = first; i < 1000; i += 2 * CONCURRENT_THREADS) {
+    htc_delete(&concurrent_table, MANY_KEYS[i]);
+  }
+  return NULL;
+}
+
+TEST(test_concurrent, "Insert and delete from multiple threads")
+  ht_init(test_table);
+  success &= htc_init(&concurrent_table, ht_hash_wy, 0);
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "t%d", i);
+  }
+  pthread_t threads[CONCURRENT_THREADS];
+  int firsts[CONCURRENT_THREADS];
+  for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+    firsts[i] = i;
+    pthread_create(&threads[i], NULL, concurrent_worker, &firsts[i]);
+  }
+  for (int i = 0; i < CONCURRENT_THREADS; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    float value;
+    bool found = htc_get(&concurrent_table, MANY_KEYS[i], &value);
+    success &= i % (2 * CONCURRENT_THREADS) < CONCURRENT_THREADS
+                   ? !found
+                   : found && value == i;
+  }
+  success &= concurrent_table.count == 500;
+  success &= concurrent_table.buckets->size > MAX_HT_SIZE;
+  htc_dispose(&concurrent_table);
+ENDTEST
+
+TEST(test_snapshot, "Save the table and map it from file")
+  ht_init(test_table);
+  INSERT_TEST_DATA(test_table)
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "s%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  ht_delete(test_table, "Terra");
+  success &= ht_snapshot_save(test_table, "test.snapshot");
+  ht_snapshot_t snapshot;
+  success &= ht_snapshot_open(&snapshot, "test.snapshot");
+  if (success) {
+    success &= snapshot.count == 1014;
+    const float *f = ht_snapshot_get(&snapshot, "Bitcoin");
+    success &= f && *f == 53247.71f;
+    success &= !ht_snapshot_get(&snapshot, "Terra");
+    for (int i = 0; i < 1000; ++i) {
+      f = ht_snapshot_get(&snapshot, MANY_KEYS[i]);
+      success &= f && *f == i;
+    }
+    const ht_snapshot_entry_t *entry = ht_snapshot_search(&snapshot, "XRP");
+    success &= entry && !strcmp(snapshot.keys + entry->key, "XRP");
+    ht_snapshot_close(&snapshot);
+  }
+  remove("test.snapshot");
+ENDTEST
+
+TEST(test_snapshot_corrupt, "Reject or safely read a corrupt snapshot")
+  ht_init(test_table);
+  INSERT_TEST_DATA(test_table)
+  success &= ht_snapshot_save(test_table, "test.snapshot");
+
+  // read the valid file and find its sections
+  ht_snapshot_t snapshot;
+  success &= ht_snapshot_open(&snapshot, "test.snapshot");
+  char *data = success ? malloc(snapshot.data_size) : NULL;
+  if (data) {
+    size_t size = snapshot.data_size;
+    size_t buckets = (const char *)snapshot.buckets - (char *)snapshot.data;
+    size_t entries = (const char *)snapshot.entries - (char *)snapshot.data;
+    int bucket_count = snapshot.size;
+    int count = snapshot.count;
+    memcpy(data, snapshot.data, size);
+    ht_snapshot_close(&snapshot);
+
+    // truncated file is rejected
+    FILE *file = fopen("test.snapshot", "wb");
+    fwrite(data, 1, size - 1, file);
+    fclose(file);
+    success &= !ht_snapshot_open(&snapshot, "test.snapshot");
+
+    // bucket indexes and key offsets out of range are ignored by lookups
+    for (int i = 0; i < bucket_count; ++i) {
+      memset(data + buckets + i * sizeof(uint32_t), 0xff, sizeof(uint32_t));
+    }
+    for (int i = 0; i < count; ++i) {
+      ht_snapshot_entry_t *entry =
+          (ht_snapshot_entry_t *)(data + entries) + i;
+      entry->key = UINT64_MAX - 1;
+    }
+    file = fopen("test.snapshot", "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+    success &= ht_snapshot_open(&snapshot, "test.snapshot");
+    if (success) {
+      success &= !ht_snapshot_get(&snapshot, "Bitcoin");
+      success &= !ht_snapshot_get(&snapshot, "XRP");
+      ht_snapshot_close(&snapshot);
+    }
+    free(data);
+  }
+  remove("test.snapshot");
+ENDTEST
+
+TEST(test_freeze, "Freeze the table to perfect hash")
+  ht_init(test_table);
+  ht_frozen_t frozen;
+  success &= ht_freeze(test_table, &frozen) && !ht_frozen_get(&frozen, "XRP");
+  ht_frozen_dispose(&frozen);
+
+  INSERT_TEST_DATA(test_table)
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "f%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  success &= ht_freeze(test_table, &frozen) && frozen.count == 1015;
+  // the frozen table has its own copy of the keys
+  ht_delete_all(test_table);
+  for (int i = 0; i < 1000; ++i) {
+    const float *f = ht_frozen_get(&frozen, MANY_KEYS[i]);
+    success &= f && *f == i;
+    sprintf(MANY_KEYS[i], "g%d", i);
+    success &= !ht_frozen_get(&frozen, MANY_KEYS[i]);
+  }
+  const float *f = ht_frozen_get(&frozen, "Terra");
+  success &= f && *f == 30.67f && !ht_frozen_get(&frozen, "Terra Classic");
+  ht_frozen_dispose(&frozen);
+ENDTEST
+
+// Adds value of the item to the sum in ctx
+static bool sum_values(ht_item_t *item, void *ctx) {
+  *(float *)ctx += item->value;
+  return true;
+}
+
+// Checks whether the value of the item is odd
+static bool is_odd(ht_item_t *item, void *ctx) {
+  (void)ctx;
+  return (int)item->value % 2;
+}
+
+TEST(test_iter, "Iterate over all the items")
+  ht_init(test_table);
+#ifdef HT_CHAINED
+  // some items are still in the old buckets after the inserts
+  test_table->rehash_budget = 1;
+#endif
+  for (int i = 0; i < 1000; ++i) {
+    sprintf(MANY_KEYS[i], "i%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  ht_iter_t iter;
+  ht_iter_begin(test_table, &iter);
+  int count = 0;
+  float sum = 0;
+  for (ht_item_t *item; (item = ht_iter_next(&iter));) {
+    ++count;
+    sum += item->value;
+    // delete every item with value divisible by 3 while iterating
+    if ((int)item->value % 3 == 0) {
+      ht_iter_delete(&iter);
+    }
+  }
+  success &= count == 1000 && sum == 999 * 500;
+  success &= test_table->count == 666 && !ht_get(test_table, "i999") &&
+             ht_get(test_table, "i998");
+  sum = 0;
+  ht_for_each(test_table, sum_values, &sum);
+  success &= sum == 999 * 500 - 333 * 501;
+  success &= ht_delete_if(test_table, is_odd, NULL) == 333;
+  success &= test_table->count == 333 && ht_get(test_table, "i2") &&
+             !ht_get(test_table, "i1");
+ENDTEST
+
+TEST(test_stats, "Collect statistics of the table")
+  ht_init(test_table);
+  INSERT_TEST_DATA(test_table)
+  ht_get(test_table, "Bitcoin");
+  ht_get(test_table, "Monero");
+  ht_delete(test_table, "XRP");
+  ht_stats_t stats;
+  ht_stats(test_table, &stats);
+  success &= stats.count == 14 && stats.size == test_table->size;
+  success &= stats.load == (float)stats.count / stats.size;
+  int counted = 0;
+  for (int i = 0; i < HT_HISTOGRAM; ++i) {
+#ifdef HT_CHAINED
+    // the histogram counts the chains
+    counted += i * stats.histogram[i];
+#else
+    // the histogram counts the items
+    counted += stats.histogram[i];
+#endif
+  }
+  success &= counted == 14 && stats.max_chain > 0;
+#ifdef HT_STATS
+  success &= stats.counters.lookups == 2 && stats.counters.hits == 1 &&
+             stats.counters.misses == 1 && stats.counters.visited > 0;
+  success &= stats.counters.inserts == 15 && stats.counters.deletes == 1 &&
+             stats.counters.rehashes > 0;
+#endif
+ENDTEST
+
+#ifdef HT_CHAINED
+
+// Gets the position of the item in the chain starting at `head`, -1 if it is
+// not there
+static int chain_position(ht_item_t *head, ht_item_t *item) {
+  for (int i = 0; head; head = head->next, ++i) {
+    if (head == item) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+TEST(test_reorder, "Move found items closer to the start of the chain")
+  ht_init(test_table);
+  // keep all the items in one chain
+  ht_resize(test_table, 1);
+  test_table->max_load = 0;
+  for (int i = 0; i < 10; ++i) {
+    sprintf(MANY_KEYS[i], "r%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+
+  // without reordering the chain doesn't change
+  ht_item_t *item = ht_search(test_table, "r5");
+  int pos = chain_position(test_table->items[0], item);
+  success &= ht_search(test_table, "r5") == item;
+  success &= pos > 0 && chain_position(test_table->items[0], item) == pos;
+
+  test_table->reorder = HT_REORDER_TRANSPOSE;
+  success &= ht_search(test_table, "r5") == item;
+  success &= chain_position(test_table->items[0], item) == pos - 1;
+
+  test_table->reorder = HT_REORDER_FRONT;
+  item = ht_search(test_table, "r9");
+  success &= test_table->items[0] == item && item->value == 9;
+  success &= ht_search(test_table, "r9") == item && test_table->count == 10;
+
+  // batch lookup reorders the chains too
+  char *batch_keys[] = {"r3", "r7"};
+  float *batch_values[2];
+  ht_get_batch(test_table, batch_keys, 2, batch_values);
+  success &= batch_values[0] && *batch_values[0] == 3;
+  success &= batch_values[1] && *batch_values[1] == 7;
+  success &= test_table->items[0]->value == 7;
+  success &= test_table->items[0]->next->value == 3;
+
+  // items that are not migrated yet are moved within the old chain
+  ht_resize(test_table, 2);
+  test_table->rehash_budget = 1;
+  ht_resize(test_table, 3);
+  // the first search migrates only the first old bucket
+  int key = 0;
+  while (key < 10 &&
+         (ht_key_hash(test_table, MANY_KEYS[key], 2) % 2 == 0 ||
+          test_table->old_items[1]->key == MANY_KEYS[key])) {
+    ++key;
+  }
+  item = ht_search(test_table, MANY_KEYS[key % 10]);
+  success &= key < 10 && test_table->old_items &&
+             test_table->old_items[1] == item;
+  for (int i = 0; i < 10; ++i) {
+    item = ht_search(test_table, MANY_KEYS[i]);
+    success &= item && item->value == i;
+  }
+ENDTEST
+
+TEST(test_filter, "Reject missing keys with the filter")
+  ht_init(test_table);
+  // the filter grows with the table from the start
+  success &= ht_use_filter(test_table, 0.01f);
+  success &= !ht_use_filter(test_table, 1.5f);
+  for (int i = 0; i < 500; ++i) {
+    sprintf(MANY_KEYS[i], "f%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  success &= test_table->filter.capacity >= 500;
+
+  // there are no false negatives, false positives are rare
+  int passed = 0;
+  for (int i = 0; i < 500; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= f && *f == i;
+    sprintf(MANY_KEYS[500 + i], "m%d", i);
+    passed += ht_filter_may_contain(
+        &test_table->filter, ht_key_hash(test_table, MANY_KEYS[500 + i],
+                                         strlen(MANY_KEYS[500 + i])));
+    success &= ht_get(test_table, MANY_KEYS[500 + i]) == NULL;
+  }
+  success &= passed < 25;
+
+  char *keys[1000];
+  float *values[1000];
+  for (int i = 0; i < 1000; ++i) {
+    keys[i] = MANY_KEYS[i];
+  }
+  ht_get_batch(test_table, keys, 1000, values);
+  for (int i = 0; i < 1000; ++i) {
+    success &= i < 500 ? values[i] && *values[i] == i : !values[i];
+  }
+
+  // deleted keys are removed from the filter
+  for (int i = 0; i < 500; i += 2) {
+    ht_delete(test_table, MANY_KEYS[i]);
+    ht_delete(test_table, MANY_KEYS[500 + i]);
+  }
+  for (int i = 0; i < 500; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= i % 2 ? f && *f == i : !f;
+  }
+  success &= test_table->count == 250;
+
+  ht_delete_all(test_table);
+  success &= !ht_filter_may_contain(&test_table->filter,
+                                    ht_key_hash(test_table, "f1", 2));
+  success &= ht_use_filter(test_table, 0) && !test_table->filter.counters;
+ENDTEST
+
+#endif // HT_CHAINED
+
+#ifdef HT_CUCKOO
+
+TEST(test_cuckoo_stash, "Keep keys whose buckets are full in the stash")
+  // the additive hash has so few values, that most keys don't fit
+  ht_init_hash(test_table, ht_hash_additive, 0);
+  for (int i = 0; i < 300; ++i) {
+    sprintf(MANY_KEYS[i], "c%d", i);
+    ht_insert(test_table, MANY_KEYS[i], i);
+  }
+  success &= test_table->count == 300 && test_table->stash_count > 0;
+  for (int i = 0; i < 300; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= f && *f == i;
+  }
+  for (int i = 0; i < 300; i += 3) {
+    ht_delete(test_table, MANY_KEYS[i]);
+  }
+  success &= ht_delete_if(test_table, is_odd, NULL) == 100;
+  for (int i = 0; i < 300; ++i) {
+    float *f = ht_get(test_table, MANY_KEYS[i]);
+    success &= i % 3 && i % 2 == 0 ? f && *f == i : !f;
+  }
+  success &= test_table->count == 100;
+ENDTEST
+
+#endif // HT_CUCKOO
+
 int main(int argc, char *argv[]) {
   init_uninitialized_item();
   init_test();
@@ -108,6 +777,35 @@ int main(int argc, char *argv[]) {
   success &= test_get();
   success &= test_delete();
   success &= test_delete_all();
+  success &= test_hash_anagrams();
+#ifdef HT_CHAINED
+  success &= test_hash_legacy();
+#endif
+  success &= test_resize_grow();
+  success &= test_resize_shrink();
+#ifdef HT_CHAINED
+  success &= test_resize_incremental();
+  success &= test_slab();
+  success &= test_own_keys();
+  success &= test_values();
+#endif
+  success &= test_hashed();
+  success &= test_simd();
+  success &= test_batch();
+  success &= test_tombstones();
+  success &= test_snapshot();
+  success &= test_snapshot_corrupt();
+  success &= test_freeze();
+  success &= test_iter();
+  success &= test_stats();
+#ifdef HT_CHAINED
+  success &= test_reorder();
+  success &= test_filter();
+#endif
+#ifdef HT_CUCKOO
+  success &= test_cuckoo_stash();
+#endif
+  success &= test_concurrent();
 
   if (success) {
     printf("\x1b[92mALL PASS\x1b[0m\n");
@@ -2,6 +2,7 @@
 #include "hashtable.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 ht_item_t *uninitialized_item;
 
@@ -21,32 +22,170 @@ void ht_print_item(ht_item_t *item) {
   }
 }
 
-void ht_print_table(ht_table_t *table) {
-  int max_count = 0;
-  int sum_count = 0;
+#if defined(HT_SWISS)
 
-  printf("------------HASH TABLE--------------\n");
-  for (int i = 0; i < HT_SIZE; i++) {
-    printf("%i: ", i);
+// Chain of item is the number of groups probed before the item is found,
+// so the average is the mean probe length of the items
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+
+  int mask = table->size / HT_GROUP_SIZE - 1;
+  for (int g = 0; g <= mask; g++) {
+    bool used = false;
+    for (int i = g * HT_GROUP_SIZE; i < (g + 1) * HT_GROUP_SIZE; i++) {
+      if (table->ctrl[i] < 0) {
+        continue;
+      }
+      uint64_t hash = table->slots[i].hash;
+      int chain = 1;
+      for (int p = (hash >> 7) & mask; p != g; p = (p + chain++) & mask)
+        ;
+      if (chain > stats->max_chain) {
+        stats->max_chain = chain;
+      }
+      stats->chain_sum += chain;
+      stats->chains++;
+      stats->items++;
+      used = true;
+    }
+    stats->used_buckets += used;
+  }
+}
+
+#elif defined(HT_CUCKOO)
+
+// Chain of item is 1 in its first bucket, 2 in the second one and 3 in the
+// stash, which counts as one more bucket
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+
+  int mask = table->size / HT_CUCKOO_SLOTS - 1;
+  for (int b = 0; b <= mask; b++) {
+    bool used = false;
+    for (int i = b * HT_CUCKOO_SLOTS; i < (b + 1) * HT_CUCKOO_SLOTS; i++) {
+      if (!table->tags[i]) {
+        continue;
+      }
+      int chain = (int)(table->slots[i].hash & mask) == b ? 1 : 2;
+      if (chain > stats->max_chain) {
+        stats->max_chain = chain;
+      }
+      stats->chain_sum += chain;
+      stats->chains++;
+      stats->items++;
+      used = true;
+    }
+    stats->used_buckets += used;
+  }
+
+  if (table->stash_count) {
+    stats->items += table->stash_count;
+    stats->used_buckets++;
+    stats->max_chain = 3;
+    stats->chain_sum += 3l * table->stash_count;
+    stats->chains += table->stash_count;
+  }
+}
+
+#else // HT_CHAINED
+
+// Adds statistics of the chains in the buckets to the stats
+static void ht_add_chain_stats(ht_item_t **items, int size,
+                               ht_chain_stats_t *stats) {
+  for (int i = 0; i < size; i++) {
     int count = 0;
-    ht_item_t *item = (*table)[i];
-    while (item != NULL) {
-      printf("(%s,%.2f)", item->key, item->value);
+    for (ht_item_t *item = items[i]; item; item = item->next) {
       if (item != uninitialized_item) {
         count++;
       }
+    }
+    if (count > stats->max_chain) {
+      stats->max_chain = count;
+    }
+    if (count) {
+      stats->used_buckets++;
+      stats->chain_sum += count;
+      stats->chains++;
+    }
+    stats->items += count;
+  }
+}
+
+// Chain of bucket is the number of its items, the average is over the non
+// empty buckets
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats) {
+  memset(stats, 0, sizeof(*stats));
+
+  ht_add_chain_stats(table->items, table->size, stats);
+  if (table->old_items) {
+    ht_add_chain_stats(table->old_items + table->migrated,
+                       table->old_size - table->migrated, stats);
+  }
+}
+
+#endif // HT_CHAINED
+
+// Gets the average of the same lengths as max_chain
+double ht_avg_chain(const ht_chain_stats_t *stats) {
+  return stats->chains ? (double)stats->chain_sum / stats->chains : 0;
+}
+
+void ht_print_table(ht_table_t *table) {
+  printf("------------HASH TABLE--------------\n");
+#if defined(HT_SWISS)
+  for (int g = 0; g < table->size / HT_GROUP_SIZE; g++) {
+    printf("%i: ", g);
+    for (int i = g * HT_GROUP_SIZE; i < (g + 1) * HT_GROUP_SIZE; i++) {
+      if (table->ctrl[i] >= 0) {
+        printf("(%s,%.2f)", table->slots[i].key, table->slots[i].value);
+      }
+    }
+    printf("\n");
+  }
+#elif defined(HT_CUCKOO)
+  for (int b = 0; b < table->size / HT_CUCKOO_SLOTS; b++) {
+    printf("%i: ", b);
+    for (int i = b * HT_CUCKOO_SLOTS; i < (b + 1) * HT_CUCKOO_SLOTS; i++) {
+      if (table->tags[i]) {
+        printf("(%s,%.2f)", table->slots[i].key, table->slots[i].value);
+      }
+    }
+    printf("\n");
+  }
+  printf("stash: ");
+  for (int i = 0; i < table->stash_count; i++) {
+    printf("(%s,%.2f)", table->stash[i].key, table->stash[i].value);
+  }
+  printf("\n");
+#else
+  for (int i = 0; i < table->size; i++) {
+    printf("%i: ", i);
+    ht_item_t *item = table->items[i];
+    while (item != NULL) {
+      printf("(%s,%.2f)", item->key, item->value);
       item = item->next;
     }
     printf("\n");
-    if (count > max_count) {
-      max_count = count;
+  }
+
+  // buckets that are not migrated yet
+  for (int i = table->old_items ? table->migrated : 0; i < table->old_size;
+       i++) {
+    printf("old %i: ", i);
+    for (ht_item_t *item = table->old_items[i]; item; item = item->next) {
+      printf("(%s,%.2f)", item->key, item->value);
     }
-    sum_count += count;
+    printf("\n");
   }
+#endif // HT_CHAINED
+
+  ht_chain_stats_t stats;
+  ht_chain_stats(table, &stats);
 
   printf("------------------------------------\n");
-  printf("Total items in hash table: %i\n", sum_count);
-  printf("Maximum hash collisions: %i\n", max_count == 0 ? 0 : max_count - 1);
+  printf("Total items in hash table: %i\n", stats.items);
+  printf("Maximum hash collisions: %i\n",
+         stats.max_chain == 0 ? 0 : stats.max_chain - 1);
   printf("------------------------------------\n");
 }
 
@@ -59,9 +198,7 @@ void init_uninitialized_item() {
 
 void init_test_table(ht_table_t **table) {
   (*table) = (ht_table_t *)malloc(sizeof(ht_table_t));
-  for (int i = 0; i < MAX_HT_SIZE; i++) {
-    (**table)[i] = uninitialized_item;
-  };
+  memset(*table, 0, sizeof(ht_table_t));
 }
 
 void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count) {
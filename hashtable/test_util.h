@@ -14,17 +14,29 @@
   printf("\n");                                                                \
   ht_print_table(test_table);                                                  \
   ht_delete_all(test_table);                                                   \
+  ht_dispose(test_table);                                                      \
   free(test_table);                                                            \
   printf("\n");                                                                \
   if (!success) printf("\x1b[91mFAILED\x1b[0m\n");                             \
   return success;                                                              \
   }
 
+// Statistics of the chain lengths in the table
+typedef struct ht_chain_stats {
+  int items;        // total number of items
+  int used_buckets; // number of non empty buckets
+  int max_chain;    // length of the longest chain
+  long chain_sum;   // sum of the lengths of the chains
+  int chains;       // number of the chains in chain_sum
+} ht_chain_stats_t;
+
 extern ht_item_t *uninitialized_item;
 
 void ht_print_item_value(float *value);
 void ht_print_item(ht_item_t *item);
 void ht_print_table(ht_table_t *table);
+void ht_chain_stats(ht_table_t *table, ht_chain_stats_t *stats);
+double ht_avg_chain(const ht_chain_stats_t *stats);
 void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count);
 
 void init_uninitialized_item();